@@ -0,0 +1,60 @@
+#pragma once
+
+/* Build profiles: select one with a cdefine in application.fam, e.g.
+ *     cdefines=["MORSE_CODE_BUILD_KEYER"],
+ * With none selected everything is built. Single features can still be
+ * forced on top of a profile, e.g. ("MORSE_CODE_FEATURE_LOG", "1").
+ * A disabled subsystem is not compiled at all: its translation unit is
+ * empty and the headers turn its hooks into no-ops. */
+
+#define MORSE_CODE_F_PLAYBACK (1 << 0) /* playback thread, text compiler, Playback menu */
+#define MORSE_CODE_F_LED (1 << 1)      /* blue / red LED during playback */
+#define MORSE_CODE_F_QSK (1 << 2)      /* break-in over playback */
+#define MORSE_CODE_F_LOOKUP (1 << 3)   /* Lookup screen */
+#define MORSE_CODE_F_TRAINING (1 << 4) /* Koch / Farnsworth training */
+#define MORSE_CODE_F_LOG (1 << 5)      /* session log, Load Last, Log Edges */
+#define MORSE_CODE_F_PROFILE (1 << 6)  /* run-time counters, Diagnostics */
+
+#if defined(MORSE_CODE_BUILD_KEYER)
+/* live keying and decoding only */
+#define MORSE_CODE_BUILD_NAME "keyer"
+#define MORSE_CODE_BUILD_FEATURES 0
+#elif defined(MORSE_CODE_BUILD_TRAINER)
+/* keying plus everything needed to practise copy */
+#define MORSE_CODE_BUILD_NAME "trainer"
+#define MORSE_CODE_BUILD_FEATURES \
+    (MORSE_CODE_F_PLAYBACK | MORSE_CODE_F_LOOKUP | MORSE_CODE_F_TRAINING)
+#else
+#define MORSE_CODE_BUILD_NAME "full"
+#define MORSE_CODE_BUILD_FEATURES                                                \
+    (MORSE_CODE_F_PLAYBACK | MORSE_CODE_F_LED | MORSE_CODE_F_QSK |               \
+     MORSE_CODE_F_LOOKUP | MORSE_CODE_F_TRAINING | MORSE_CODE_F_LOG |            \
+     MORSE_CODE_F_PROFILE)
+#endif
+
+#ifndef MORSE_CODE_FEATURE_PLAYBACK
+#define MORSE_CODE_FEATURE_PLAYBACK ((MORSE_CODE_BUILD_FEATURES & MORSE_CODE_F_PLAYBACK) != 0)
+#endif
+#ifndef MORSE_CODE_FEATURE_LED
+#define MORSE_CODE_FEATURE_LED ((MORSE_CODE_BUILD_FEATURES & MORSE_CODE_F_LED) != 0)
+#endif
+#ifndef MORSE_CODE_FEATURE_QSK
+#define MORSE_CODE_FEATURE_QSK ((MORSE_CODE_BUILD_FEATURES & MORSE_CODE_F_QSK) != 0)
+#endif
+#ifndef MORSE_CODE_FEATURE_LOOKUP
+#define MORSE_CODE_FEATURE_LOOKUP ((MORSE_CODE_BUILD_FEATURES & MORSE_CODE_F_LOOKUP) != 0)
+#endif
+#ifndef MORSE_CODE_FEATURE_TRAINING
+#define MORSE_CODE_FEATURE_TRAINING ((MORSE_CODE_BUILD_FEATURES & MORSE_CODE_F_TRAINING) != 0)
+#endif
+#ifndef MORSE_CODE_FEATURE_LOG
+#define MORSE_CODE_FEATURE_LOG ((MORSE_CODE_BUILD_FEATURES & MORSE_CODE_F_LOG) != 0)
+#endif
+#ifndef MORSE_CODE_FEATURE_PROFILE
+#define MORSE_CODE_FEATURE_PROFILE ((MORSE_CODE_BUILD_FEATURES & MORSE_CODE_F_PROFILE) != 0)
+#endif
+
+#if !MORSE_CODE_FEATURE_PLAYBACK && \
+    (MORSE_CODE_FEATURE_LED || MORSE_CODE_FEATURE_QSK || MORSE_CODE_FEATURE_TRAINING)
+#error "LED, QSK and training need MORSE_CODE_FEATURE_PLAYBACK"
+#endif
@@ -0,0 +1,114 @@
+#include "morse_code_core.h"
+#include <string.h>
+
+/* Morse tables (A–Z, 1–0) */
+const char morse_code_table[MORSE_CODE_SYMBOLS][MORSE_CODE_MAX_ELEMENTS + 1] = {
+    ".-","-...","-.-.","-..",".","..-.",
+    "--.","....","..",".---","-.-",".-..",
+    "--","-.","---",".--.","--.-",".-.",
+    "...","-","..-","...-",".--","-..-",
+    "-.--","--..",".----","..---","...--","....-",
+    ".....","-....","--...","---..","----.","-----"
+};
+const char morse_code_symbols[MORSE_CODE_SYMBOLS] = {
+    'A','B','C','D','E','F','G','H','I','J','K','L',
+    'M','N','O','P','Q','R','S','T','U','V','W','X',
+    'Y','Z','1','2','3','4','5','6','7','8','9','0'
+};
+
+const char* morse_code_encode_char(char c) {
+    if(c >= 'a' && c <= 'z') c = (char)(c - 'a' + 'A');
+    for(size_t i = 0; i < MORSE_CODE_SYMBOLS; i++) {
+        if(morse_code_symbols[i] == c) return morse_code_table[i];
+    }
+    return NULL;
+}
+
+char morse_code_decode_code(const char* code) {
+    for(size_t i = 0; i < MORSE_CODE_SYMBOLS; i++) {
+        if(strcmp(code, morse_code_table[i]) == 0) return morse_code_symbols[i];
+    }
+    return 0;
+}
+
+#if MORSE_CODE_FEATURE_PLAYBACK
+size_t morse_code_compile(const char* s, size_t len, uint8_t* elements, size_t max) {
+    size_t count = 0;
+    for(size_t n = 0; n < len; n++) {
+        uint8_t buf[MORSE_CODE_CHAR_ELEMENTS_MAX];
+        size_t k = 0;
+        if(s[n] == ' ') {
+            buf[k++] = MorseCodeElementGapWord;
+        } else {
+            const char* code = morse_code_encode_char(s[n]);
+            for(size_t i = 0; code && code[i] != '\0'; i++) {
+                buf[k++] = (code[i] == '.') ? MorseCodeElementDit : MorseCodeElementDah;
+                if(code[i + 1] != '\0') buf[k++] = MorseCodeElementGapElement;
+            }
+            buf[k++] = MorseCodeElementGapLetter;
+        }
+
+        /* letters are emitted whole or not at all */
+        if(count + k > max) break;
+        memcpy(elements + count, buf, k);
+        count += k;
+    }
+    return count;
+}
+
+uint32_t morse_code_element_ms(uint8_t element, uint32_t dit, uint32_t gap_delta) {
+    const uint32_t gap = (gap_delta > dit) ? gap_delta : dit;
+    switch(element) {
+    case MorseCodeElementDit:
+    case MorseCodeElementGapElement:
+        return dit;
+    case MorseCodeElementDah:
+        return 3 * dit;
+    case MorseCodeElementGapLetter:
+        return 3 * gap;
+    case MorseCodeElementGapWord:
+        return 7 * gap;
+    default:
+        return 0;
+    }
+}
+#endif
+
+void morse_code_decoder_reset(MorseCodeDecoder* decoder) {
+    decoder->len = 0;
+    decoder->code[0] = '\0';
+}
+
+void morse_code_decoder_mark(MorseCodeDecoder* decoder, uint32_t duration, uint32_t dot_max) {
+    if(duration > dot_max * 3 || decoder->len >= MORSE_CODE_MAX_ELEMENTS) {
+        morse_code_decoder_reset(decoder);
+        return;
+    }
+    decoder->code[decoder->len++] = (duration <= dot_max) ? '.' : '-';
+    decoder->code[decoder->len] = '\0';
+}
+
+bool morse_code_decoder_pending(const MorseCodeDecoder* decoder) {
+    return decoder->len > 0;
+}
+
+char morse_code_decoder_letter(MorseCodeDecoder* decoder) {
+    const char c = decoder->len ? morse_code_decode_code(decoder->code) : 0;
+    morse_code_decoder_reset(decoder);
+    return c;
+}
+
+size_t morse_code_decoder_gap(
+    MorseCodeDecoder* decoder,
+    uint32_t gap,
+    uint32_t letter_gap,
+    uint32_t word_gap,
+    char* out) {
+    size_t n = 0;
+    if(gap > letter_gap && decoder->len) {
+        const char c = morse_code_decoder_letter(decoder);
+        if(c) out[n++] = c;
+        if(gap > word_gap) out[n++] = ' ';
+    }
+    return n;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "morse_code_config.h"
+
+/* Morse tables and decode logic shared by the worker and the host tools
+ * (tools/); plain C, no furi dependencies */
+
+#define MORSE_CODE_SYMBOLS 36     /* A–Z, 1–0 */
+#define MORSE_CODE_MAX_ELEMENTS 5 /* longest code */
+
+extern const char morse_code_table[MORSE_CODE_SYMBOLS][MORSE_CODE_MAX_ELEMENTS + 1];
+extern const char morse_code_symbols[MORSE_CODE_SYMBOLS];
+
+/* case-insensitive; NULL for space and unknown characters */
+const char* morse_code_encode_char(char c);
+/* "." / "-" string -> symbol, 0 if it is not a known code */
+char morse_code_decode_code(const char* code);
+
+/* Keying elements: text compiles to a flat array of these, which the
+ * playback thread walks (and the host tools turn into timelines / audio) */
+typedef enum {
+    MorseCodeElementDit,        /* tone, 1 dit */
+    MorseCodeElementDah,        /* tone, 3 dits */
+    MorseCodeElementGapElement, /* silence, 1 dit */
+    MorseCodeElementGapLetter,  /* silence, 3 gap units */
+    MorseCodeElementGapWord,    /* silence, 7 gap units */
+} MorseCodeElement;
+
+/* Keying thread gap rules, in Dits: a silence longer than 3 ends the
+ * letter, longer than 7 also ends the word. The Dit setting is the dot /
+ * dash threshold rather than a nominal dot, so these leave room for slow
+ * or uneven fists */
+#define MORSE_CODE_LETTER_GAP_UNITS 3
+#define MORSE_CODE_WORD_GAP_UNITS 7
+
+/* most elements one character compiles to: 5 marks, 4 gaps, letter gap */
+#define MORSE_CODE_CHAR_ELEMENTS_MAX (2 * MORSE_CODE_MAX_ELEMENTS)
+
+#if MORSE_CODE_FEATURE_PLAYBACK
+/* Each character maps on its own: marks separated by element gaps, then a
+ * letter gap; space is a word gap; unknown characters only take the letter
+ * gap. Stops at the last character that fits in `max`; returns the count */
+size_t morse_code_compile(const char* s, size_t len, uint8_t* elements, size_t max);
+
+/* element length in ms; a gap_delta above dit stretches letter / word gaps
+ * (Farnsworth) */
+uint32_t morse_code_element_ms(uint8_t element, uint32_t dit, uint32_t gap_delta);
+#endif
+
+static inline bool morse_code_element_is_tone(uint8_t element) {
+    return element == MorseCodeElementDit || element == MorseCodeElementDah;
+}
+
+/* Element accumulator for one signal */
+typedef struct {
+    char code[MORSE_CODE_MAX_ELEMENTS + 1];
+    uint8_t len;
+} MorseCodeDecoder;
+
+void morse_code_decoder_reset(MorseCodeDecoder* decoder);
+/* a mark of `duration` ended: <= dot_max is a dot, <= 3 * dot_max a dash,
+ * anything longer (or a sixth element) discards the letter in progress */
+void morse_code_decoder_mark(MorseCodeDecoder* decoder, uint32_t duration, uint32_t dot_max);
+bool morse_code_decoder_pending(const MorseCodeDecoder* decoder);
+/* letter gap seen: returns the decoded symbol (0 if none) and resets */
+char morse_code_decoder_letter(MorseCodeDecoder* decoder);
+/* A whole silence of `gap` ms after a mark: a pending letter ends past
+ * `letter_gap` ms, and is followed by a word space past `word_gap` ms.
+ * Writes up to two characters to `out`, returns how many */
+size_t morse_code_decoder_gap(
+    MorseCodeDecoder* decoder,
+    uint32_t gap,
+    uint32_t letter_gap,
+    uint32_t word_gap,
+    char* out);
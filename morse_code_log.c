@@ -0,0 +1,276 @@
+#include "morse_code_log.h"
+
+#if MORSE_CODE_FEATURE_LOG
+#include <furi_hal.h>
+#include <storage/storage.h>
+#include <lib/flipper_format/flipper_format.h>
+#include <stdio.h>
+#include <string.h>
+
+#define TAG "MorseCodeLog"
+
+/* File layout: FlipperFormat header, then one "Key: values" line per record
+ *   C: <ms since session start> <ascii>   decoded character
+ *   E: <1 = key down, 0 = key up> <ms>    raw edge duration (optional)
+ */
+#define MORSE_CODE_LOG_PATH APP_DATA_PATH("session.txt")
+#define MORSE_CODE_LOG_LAST_PATH APP_DATA_PATH("session_last.txt")
+#define MORSE_CODE_LOG_FILETYPE "Morse Code Plus Session"
+#define MORSE_CODE_LOG_VERSION 1
+
+#define MORSE_CODE_LOG_RECORD_MAX 32
+/* hand a block to the flush thread once it is this full */
+#define MORSE_CODE_LOG_BLOCK_HIGH (MORSE_CODE_LOG_BLOCK_SIZE * 3 / 4)
+
+typedef enum {
+    MorseCodeLogFlagFlush = (1 << 0),
+    MorseCodeLogFlagStop = (1 << 1),
+} MorseCodeLogFlag;
+
+struct MorseCodeLog {
+    FuriThread* thread; /* started with the first record */
+    bool thread_started;
+    FuriMutex* mutex;   /* guards the buffers only, never held across storage I/O */
+    FuriMutex* io_mutex; /* serializes flush thread vs reader on the files */
+
+    /* double buffer: producers fill `front`, the flush thread drains `back` */
+    char* front;
+    char* back;
+    size_t front_len;
+    size_t back_len;    /* non-zero while the flush thread owns `back` */
+    uint32_t dropped;
+
+    uint32_t start_tick;
+    uint32_t started; /* RTC time at start_tick, the base of the C: offsets */
+    bool edges;
+
+    /* flush thread only (rotated is also read by the reader under io_mutex) */
+    FlipperFormat* file;
+    bool open_failed;
+    bool rotated;
+};
+
+/* ---------- flush thread ---------- */
+
+static bool morse_code_log_open(MorseCodeLog* log, Storage* storage) {
+    if(log->file) return true;
+    if(log->open_failed) return false;
+
+    /* keep exactly one previous session around for the reader */
+    if(storage_common_stat(storage, MORSE_CODE_LOG_PATH, NULL) == FSE_OK) {
+        storage_common_remove(storage, MORSE_CODE_LOG_LAST_PATH);
+        storage_common_rename(storage, MORSE_CODE_LOG_PATH, MORSE_CODE_LOG_LAST_PATH);
+    }
+    log->rotated = true;
+
+    log->file = flipper_format_file_alloc(storage);
+    if(!flipper_format_file_open_always(log->file, MORSE_CODE_LOG_PATH) ||
+       !flipper_format_write_header_cstr(log->file, MORSE_CODE_LOG_FILETYPE, MORSE_CODE_LOG_VERSION) ||
+       !flipper_format_write_uint32(log->file, "Started", &log->started, 1)) {
+        FURI_LOG_E(TAG, "Cannot open %s", MORSE_CODE_LOG_PATH);
+        flipper_format_free(log->file);
+        log->file = NULL;
+        log->open_failed = true;
+        return false;
+    }
+    return true;
+}
+
+static void morse_code_log_swap(MorseCodeLog* log) {
+    char* t = log->back;
+    log->back = log->front;
+    log->front = t;
+    log->back_len = log->front_len;
+    log->front_len = 0;
+}
+
+/* write out `back`; with `partial` also take a not-yet-full front block */
+static bool morse_code_log_drain(MorseCodeLog* log, Storage* storage, bool partial) {
+    furi_mutex_acquire(log->mutex, FuriWaitForever);
+    if(partial && log->back_len == 0 && log->front_len > 0) morse_code_log_swap(log);
+    const size_t pending = log->back_len;
+    furi_mutex_release(log->mutex);
+    if(pending == 0) return false;
+
+    furi_mutex_acquire(log->io_mutex, FuriWaitForever);
+    if(morse_code_log_open(log, storage)) {
+        Stream* stream = flipper_format_get_raw_stream(log->file);
+        if(stream_write(stream, (const uint8_t*)log->back, pending) != pending) {
+            FURI_LOG_E(TAG, "Short write");
+        }
+    }
+    furi_mutex_release(log->io_mutex);
+
+    furi_mutex_acquire(log->mutex, FuriWaitForever);
+    log->back_len = 0;
+    furi_mutex_release(log->mutex);
+    return true;
+}
+
+static int32_t morse_code_log_thread(void* context) {
+    furi_assert(context);
+    MorseCodeLog* log = context;
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+
+    bool running = true;
+    while(running) {
+        const uint32_t flags = furi_thread_flags_wait(
+            MorseCodeLogFlagFlush | MorseCodeLogFlagStop, FuriFlagWaitAny, MORSE_CODE_LOG_FLUSH_MS);
+        /* a timeout also flushes a partial block so little is lost on a crash */
+        const bool timeout = (flags & FuriFlagError) != 0;
+        if(!timeout && (flags & MorseCodeLogFlagStop)) running = false;
+
+        morse_code_log_drain(log, storage, timeout);
+        if(!running) {
+            while(morse_code_log_drain(log, storage, true)) {
+            }
+        }
+    }
+
+    if(log->file) {
+        flipper_format_file_close(log->file);
+        flipper_format_free(log->file);
+        log->file = NULL;
+    }
+    furi_record_close(RECORD_STORAGE);
+    return 0;
+}
+
+/* ---------- producers ---------- */
+
+static void morse_code_log_append(MorseCodeLog* log, const char* rec, size_t len) {
+    bool kick = false;
+
+    furi_mutex_acquire(log->mutex, FuriWaitForever);
+    if(!log->thread_started) {
+        /* sessions with nothing decoded never touch storage */
+        log->thread_started = true;
+        furi_thread_start(log->thread);
+    }
+    if(log->front_len + len > MORSE_CODE_LOG_BLOCK_SIZE) {
+        /* flush thread still busy with the other block: drop, never stall the caller */
+        log->dropped++;
+    } else {
+        memcpy(log->front + log->front_len, rec, len);
+        log->front_len += len;
+    }
+    if(log->front_len >= MORSE_CODE_LOG_BLOCK_HIGH && log->back_len == 0) {
+        morse_code_log_swap(log);
+        kick = true;
+    }
+    furi_mutex_release(log->mutex);
+
+    if(kick) furi_thread_flags_set(furi_thread_get_id(log->thread), MorseCodeLogFlagFlush);
+}
+
+void morse_code_log_char(MorseCodeLog* log, char c) {
+    furi_assert(log);
+    char rec[MORSE_CODE_LOG_RECORD_MAX];
+    int len = snprintf(
+        rec,
+        sizeof(rec),
+        "C: %lu %u\n",
+        (unsigned long)(furi_get_tick() - log->start_tick),
+        (unsigned)(uint8_t)c);
+    if(len > 0) morse_code_log_append(log, rec, (size_t)len);
+}
+
+void morse_code_log_edge(MorseCodeLog* log, bool key_down, uint32_t duration) {
+    furi_assert(log);
+    if(!log->edges) return;
+    char rec[MORSE_CODE_LOG_RECORD_MAX];
+    int len =
+        snprintf(rec, sizeof(rec), "E: %u %lu\n", key_down ? 1u : 0u, (unsigned long)duration);
+    if(len > 0) morse_code_log_append(log, rec, (size_t)len);
+}
+
+void morse_code_log_set_edges(MorseCodeLog* log, bool enabled) {
+    furi_assert(log);
+    log->edges = enabled;
+}
+
+/* ---------- reader ---------- */
+
+bool morse_code_log_load_last(MorseCodeLog* log, FuriString* out, size_t max_len) {
+    furi_assert(log);
+    furi_assert(out);
+    furi_string_reset(out);
+
+    furi_mutex_acquire(log->io_mutex, FuriWaitForever);
+    /* until this session writes its first block, the old file has not been rotated yet */
+    const char* path = log->rotated ? MORSE_CODE_LOG_LAST_PATH : MORSE_CODE_LOG_PATH;
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    FlipperFormat* file = flipper_format_file_alloc(storage);
+    FuriString* filetype = furi_string_alloc();
+    bool loaded = false;
+    do {
+        uint32_t version = 0;
+        if(!flipper_format_file_open_existing(file, path)) break;
+        if(!flipper_format_read_header(file, filetype, &version)) break;
+        if(furi_string_cmp_str(filetype, MORSE_CODE_LOG_FILETYPE) != 0 ||
+           version != MORSE_CODE_LOG_VERSION)
+            break;
+
+        /* "E" lines are skipped by the key seek */
+        uint32_t rec[2];
+        while(flipper_format_read_uint32(file, "C", rec, 2)) {
+            furi_string_push_back(out, (char)rec[1]);
+            if(max_len && furi_string_size(out) > max_len) furi_string_right(out, 1);
+        }
+        loaded = true;
+    } while(false);
+
+    furi_string_free(filetype);
+    flipper_format_free(file);
+    furi_record_close(RECORD_STORAGE);
+    furi_mutex_release(log->io_mutex);
+
+    if(!loaded) FURI_LOG_W(TAG, "No previous session in %s", path);
+    return loaded;
+}
+
+/* ---------- lifecycle ---------- */
+
+MorseCodeLog* morse_code_log_alloc(void) {
+    MorseCodeLog* log = malloc(sizeof(MorseCodeLog));
+    log->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    log->io_mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    log->front = malloc(MORSE_CODE_LOG_BLOCK_SIZE);
+    log->back = malloc(MORSE_CODE_LOG_BLOCK_SIZE);
+    log->front_len = 0;
+    log->back_len = 0;
+    log->dropped = 0;
+    log->start_tick = furi_get_tick();
+    log->started = furi_hal_rtc_get_timestamp();
+    log->edges = false;
+    log->file = NULL;
+    log->open_failed = false;
+    log->rotated = false;
+
+    log->thread = furi_thread_alloc();
+    furi_thread_set_name(log->thread, "MorseLog");
+    furi_thread_set_stack_size(log->thread, 2048);
+    furi_thread_set_context(log->thread, log);
+    furi_thread_set_callback(log->thread, morse_code_log_thread);
+    log->thread_started = false;
+    return log;
+}
+
+void morse_code_log_free(MorseCodeLog* log) {
+    furi_assert(log);
+    if(log->thread_started) {
+        furi_thread_flags_set(furi_thread_get_id(log->thread), MorseCodeLogFlagStop);
+        furi_thread_join(log->thread);
+    }
+    furi_thread_free(log->thread);
+
+    if(log->dropped) FURI_LOG_W(TAG, "Dropped %lu records", (unsigned long)log->dropped);
+
+    free(log->front);
+    free(log->back);
+    furi_mutex_free(log->io_mutex);
+    furi_mutex_free(log->mutex);
+    free(log);
+}
+#endif
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <furi.h>
+#include "morse_code_config.h"
+
+/* RAM staging: records are batched into blocks and written off-thread */
+#define MORSE_CODE_LOG_BLOCK_SIZE 1024
+#define MORSE_CODE_LOG_FLUSH_MS 5000
+
+typedef struct MorseCodeLog MorseCodeLog;
+
+#if MORSE_CODE_FEATURE_LOG
+/* lifecycle (free flushes whatever is still buffered) */
+MorseCodeLog* morse_code_log_alloc(void);
+void morse_code_log_free(MorseCodeLog* log);
+
+/* raw key-down / key-up durations are only recorded when enabled */
+void morse_code_log_set_edges(MorseCodeLog* log, bool enabled);
+
+/* producers (safe from any thread, never touch storage) */
+void morse_code_log_char(MorseCodeLog* log, char c);
+void morse_code_log_edge(MorseCodeLog* log, bool key_down, uint32_t duration);
+
+/* reader: decoded text of the previous session, tail limited to max_len */
+bool morse_code_log_load_last(MorseCodeLog* log, FuriString* out, size_t max_len);
+#else
+/* logging compiled out: alloc gives NULL, nothing is recorded or loaded */
+static inline MorseCodeLog* morse_code_log_alloc(void) {
+    return NULL;
+}
+static inline void morse_code_log_free(MorseCodeLog* log) {
+    UNUSED(log);
+}
+static inline void morse_code_log_set_edges(MorseCodeLog* log, bool enabled) {
+    UNUSED(log);
+    UNUSED(enabled);
+}
+static inline void morse_code_log_char(MorseCodeLog* log, char c) {
+    UNUSED(log);
+    UNUSED(c);
+}
+static inline void morse_code_log_edge(MorseCodeLog* log, bool key_down, uint32_t duration) {
+    UNUSED(log);
+    UNUSED(key_down);
+    UNUSED(duration);
+}
+#endif
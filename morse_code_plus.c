@@ -1,4 +1,8 @@
 #include "morse_code_worker.h"
+#include "morse_code_log.h"
+#include "morse_code_settings.h"
+#include "morse_code_training.h"
+#include "morse_code_profile.h"
 #include <furi.h>
 #include <gui/gui.h>
 #include <gui/elements.h>
@@ -8,27 +12,17 @@
 #include <string.h>
 #include <stdbool.h>
 
+#define TAG "MorseCodePlus"
+
 /* =========================
- *  Constants & Morse tables
+ *  Constants
  * ========================= */
 
+#if MORSE_CODE_FEATURE_LOOKUP
+/* the Morse codes themselves come from morse_code_core */
 static const char* LOOKUP_ALPHABET = "ABCDEFGHIJKLMNOPQRSTUVWXYZ1234567890 ";
 static const size_t LOOKUP_ALPHABET_LEN = 26 + 10 + 1;
-
-/* Morse table (A–Z, 1–0) */
-static const char MORSE_TABLE[36][6] = {
-    ".-","-...","-.-.","-..",".","..-.",
-    "--.","....","..",".---","-.-",".-..",
-    "--","-.","---",".--.","--.-",".-.",
-    "...","-","..-","...-",".--","-..-",
-    "-.--","--..",".----","..---","...--","....-",
-    ".....","-....","--...","---..","----.","-----"
-};
-static const char SYMBOL_TABLE[36] = {
-    'A','B','C','D','E','F','G','H','I','J','K','L',
-    'M','N','O','P','Q','R','S','T','U','V','W','X',
-    'Y','Z','1','2','3','4','5','6','7','8','9','0'
-};
+#endif
 
 static const float MORSE_CODE_VOLUMES[] = {0.0f, 0.25f, 0.5f, 0.75f, 1.0f};
 
@@ -36,26 +30,110 @@ static const float MORSE_CODE_VOLUMES[] = {0.0f, 0.25f, 0.5f, 0.75f, 1.0f};
  *  App state
  * ============= */
 
-typedef enum { STATE_MAIN = 0, STATE_MENU, STATE_LOOKUP } AppState;
+typedef enum { STATE_MAIN = 0, STATE_MENU, STATE_LOOKUP, STATE_TRAIN, STATE_DIAG } AppState;
+
+typedef enum {
+    EventTypeInput,
+    EventTypeTrainingCopied, /* worker decoded the last character of a group */
+} MorseCodeEventType;
+
+typedef struct {
+    MorseCodeEventType type;
+    InputEvent input;
+} MorseCodeEvent;
+
+/* entries follow the build profile (morse_code_config.h) */
+typedef enum {
+    MENU_ERASE = 0,
+#if MORSE_CODE_FEATURE_LOOKUP
+    MENU_LOOKUP,
+#endif
+#if MORSE_CODE_FEATURE_PLAYBACK
+    MENU_PLAYBACK,
+#endif
+#if MORSE_CODE_FEATURE_TRAINING
+    MENU_TRAINING,
+#endif
+#if MORSE_CODE_FEATURE_LOG
+    MENU_LOAD_LAST,
+    MENU_LOG_EDGES,
+#endif
+#if MORSE_CODE_FEATURE_QSK
+    MENU_BREAK_IN,
+#endif
+#if MORSE_CODE_FEATURE_PROFILE
+    MENU_DIAGNOSTICS,
+#endif
+    MENU_EXIT,
+    MENU_COUNT,
+} MenuItem;
+
+#define MENU_VISIBLE 4
+
+/* keying strip on the main screen: one XBM blit, left of the volume bar */
+#define STRIP_X 0
+#define STRIP_Y 44
+#define STRIP_W 120 /* samples shown, multiple of 8 */
+#define STRIP_H 5   /* 4 rows of key state + 1 baseline row */
+#define STRIP_REFRESH_MS 60
+#define TRANSCRIPT_MAX 63 /* worker wraps its text past this */
+#define TRAIN_GAP_STEP 10
+#define DIAG_REFRESH_TICKS 8 /* x STRIP_REFRESH_MS */
+#define APP_STACK_SIZE 1024  /* application.fam stack_size */
 
 typedef struct {
     FuriString* words;      /* live decoded / composed text */
     uint8_t volume;         /* 0..4 index into MORSE_CODE_VOLUMES */
     uint32_t dit_delta;     /* ms for dot */
     AppState state;
-    uint8_t menu_index;     /* menu cursor 0..3 */
-    uint8_t lookup_index;   /* index into LOOKUP_ALPHABET */
+    uint8_t menu_index;     /* MenuItem cursor */
     bool back_guard;        /* swallow Back until release to prevent retrigger */
+    /* kept in every build so settings round-trip unchanged */
+    bool log_edges;         /* session log also records raw key durations */
+    uint8_t qsk;            /* MorseCodeQsk: keying during playback */
+
+#if MORSE_CODE_FEATURE_LOOKUP
+    /* lookup (STATE_LOOKUP) */
+    uint8_t lookup_index;   /* index into LOOKUP_ALPHABET */
     bool lookup_ok_guard;   /* swallow OK right after entering LOOKUP */
+#endif
+
+#if MORSE_CODE_FEATURE_TRAINING
+    /* training (STATE_TRAIN) */
+    FuriString* train_saved; /* transcript stashed while training */
+    size_t train_fed;        /* chars of `words` already fed to training */
+    bool train_posted;       /* group-copied event already queued */
+    bool train_has_result;
+    MorseCodeTrainingResult train_result;
+#endif
+
+#if MORSE_CODE_FEATURE_PROFILE
+    /* diagnostics (STATE_DIAG) */
+    const char* diag_note; /* outcome of the last dump, NULL = none */
+#endif
 } MorseCodeModel;
 
 typedef struct {
     MorseCodeModel* model;
     FuriMutex* model_mutex;
-    FuriMessageQueue* input_queue;
+    FuriMessageQueue* event_queue;
     ViewPort* view_port;
     Gui* gui;
     MorseCodeWorker* worker;
+    MorseCodeLog* log;
+#if MORSE_CODE_FEATURE_TRAINING
+    MorseCodeTraining* training; /* allocated on first use, guarded by model_mutex */
+#endif
+    MorseCodeProfile* profile;
+    FuriTimer* strip_timer; /* one-shot, re-armed only by frames showing live state */
+    bool live_redraw; /* last frame showed live worker state (strip, playback) */
+    uint8_t live_every; /* redraw live frames every N x STRIP_REFRESH_MS */
+    MorseCodeSettings settings; /* as loaded, to skip the save when unchanged */
+
+    /* startup timing: entry point -> first rendered frame */
+    uint32_t launch_tick;
+    uint32_t first_frame_ms;
+    bool first_frame_done;
 } MorseCode;
 
 /* =============
@@ -68,14 +146,6 @@ static void draw_simple_title(Canvas* c, const char* t){
     canvas_draw_line(c, 4, 14, 123, 14);
 }
 
-static const char* morse_for_char(char c) {
-    if(c >= 'a' && c <= 'z') c = (char)(c - 'a' + 'A');
-    for(size_t i = 0; i < 36; i++) {
-        if(SYMBOL_TABLE[i] == c) return MORSE_TABLE[i];
-    }
-    return NULL; /* no code (space or unknown) */
-}
-
 /* =============
  *  UI: Menu
  * ============= */
@@ -83,13 +153,40 @@ static const char* morse_for_char(char c) {
 static void draw_menu(Canvas* canvas, MorseCodeModel* m) {
     draw_simple_title(canvas, "Morse Menu");
     canvas_set_font(canvas, FontSecondary);
-    const char* items[4] = {"Erase", "Lookup", "Playback", "Exit"};
+    const char* items[MENU_COUNT] = {
+        [MENU_ERASE] = "Erase",
+#if MORSE_CODE_FEATURE_LOOKUP
+        [MENU_LOOKUP] = "Lookup",
+#endif
+#if MORSE_CODE_FEATURE_PLAYBACK
+        [MENU_PLAYBACK] = "Playback",
+#endif
+#if MORSE_CODE_FEATURE_TRAINING
+        [MENU_TRAINING] = "Training",
+#endif
+#if MORSE_CODE_FEATURE_LOG
+        [MENU_LOAD_LAST] = "Load Last",
+        [MENU_LOG_EDGES] = m->log_edges ? "Log Edges: On" : "Log Edges: Off",
+#endif
+#if MORSE_CODE_FEATURE_QSK
+        [MENU_BREAK_IN] = (m->qsk == MorseCodeQskResume) ? "Break-in: Resume" :
+                          (m->qsk == MorseCodeQskAbort)  ? "Break-in: Abort" :
+                                                           "Break-in: Off",
+#endif
+#if MORSE_CODE_FEATURE_PROFILE
+        [MENU_DIAGNOSTICS] = "Diagnostics",
+#endif
+        [MENU_EXIT] = "Exit",
+    };
+
+    /* scroll a window of MENU_VISIBLE rows so the cursor stays on-screen */
+    const int top = (m->menu_index < MENU_VISIBLE) ? 0 : m->menu_index - (MENU_VISIBLE - 1);
 
     int y = 24;
     const int step = 12;
-    for(int i = 0; i < 4; i++) {
+    for(int i = top; i < top + MENU_VISIBLE && i < MENU_COUNT; i++) {
         if(m->menu_index == i) {
-            canvas_draw_box(canvas, 4, y - 9, 120, 12);
+            canvas_draw_box(canvas, 4, y - 9, 118, 12);
             canvas_set_color(canvas, ColorWhite);
             canvas_draw_str(canvas, 8, y, items[i]);
             canvas_set_color(canvas, ColorBlack);
@@ -98,9 +195,11 @@ static void draw_menu(Canvas* canvas, MorseCodeModel* m) {
         }
         y += step;
     }
+    elements_scrollbar(canvas, m->menu_index, MENU_COUNT);
     /* No bottom hints here to keep all items visible on-screen */
 }
 
+#if MORSE_CODE_FEATURE_LOOKUP
 /* =============
  *  UI: Lookup
  * ============= */
@@ -123,7 +222,7 @@ static void draw_lookup(Canvas* canvas, MorseCodeModel* m) {
     canvas_draw_str(canvas, 8, 34, left_label);
 
     /* Right: small “.-” text at top-right */
-    const char* code = morse_for_char(sym);
+    const char* code = morse_code_encode_char(sym); /* NULL for space */
     canvas_set_font(canvas, FontSecondary);
     if(code) {
         canvas_draw_str_aligned(canvas, 120, 22, AlignRight, AlignCenter, code);
@@ -150,7 +249,163 @@ static void draw_lookup(Canvas* canvas, MorseCodeModel* m) {
     /* Bottom hints for lookup controls */
     elements_button_left(canvas, "Back");
     elements_button_center(canvas, "Add");
+#if MORSE_CODE_FEATURE_PLAYBACK
     elements_button_right(canvas, "Play");
+#endif
+}
+#endif
+
+#if MORSE_CODE_FEATURE_TRAINING
+/* =============
+ *  UI: Training
+ * ============= */
+
+static void draw_training(Canvas* canvas, MorseCode* app, MorseCodeModel* m) {
+    MorseCodeWorkerStatus st;
+    morse_code_worker_get_status(app->worker, &st);
+    /* keep redrawing until playback ends so the prompt flips to "Copy" */
+    app->live_redraw = st.playback_active;
+    app->live_every = 1;
+
+    char line[40];
+    snprintf(
+        line,
+        sizeof(line),
+        "Koch %u  Gap %lu",
+        morse_code_training_level(app->training),
+        (unsigned long)morse_code_training_get_gap(app->training));
+    draw_simple_title(canvas, line);
+
+    canvas_set_font(canvas, FontSecondary);
+    if(st.playback_active) {
+        canvas_draw_str(canvas, 4, 26, "Listen...");
+    } else {
+        snprintf(line, sizeof(line), "Copy: %s_", furi_string_get_cstr(m->words));
+        canvas_draw_str(canvas, 4, 26, line);
+    }
+
+    if(m->train_has_result) {
+        const MorseCodeTrainingResult* r = &m->train_result;
+        snprintf(line, sizeof(line), "%s > %s", r->sent, r->copied);
+        canvas_draw_str(canvas, 4, 38, line);
+        snprintf(
+            line,
+            sizeof(line),
+            "%u/%u  %lu ms%s",
+            r->correct,
+            r->total,
+            (unsigned long)r->latency_ms,
+            r->leveled_up ? "  Level up!" : "");
+        canvas_draw_str(canvas, 4, 48, line);
+    }
+
+    elements_button_left(canvas, "Replay");
+    elements_button_right(canvas, "Skip");
+}
+#endif
+
+#if MORSE_CODE_FEATURE_PROFILE
+/* =============
+ *  UI: Diagnostics
+ * ============= */
+
+/* compact counter: 1234, 12k, 3M */
+static void format_count(char* out, size_t size, uint32_t n) {
+    if(n < 10000)
+        snprintf(out, size, "%lu", (unsigned long)n);
+    else if(n < 10000000)
+        snprintf(out, size, "%luk", (unsigned long)(n / 1000));
+    else
+        snprintf(out, size, "%luM", (unsigned long)(n / 1000000));
+}
+
+static void draw_diag(Canvas* canvas, MorseCode* app, MorseCodeModel* m) {
+    app->live_redraw = true;
+    app->live_every = DIAG_REFRESH_TICKS;
+
+    const uint32_t uptime_ms = morse_code_profile_uptime_ms(app->profile);
+    char line[32];
+    snprintf(line, sizeof(line), "Diagnostics %lus", (unsigned long)(uptime_ms / 1000));
+    draw_simple_title(canvas, line);
+
+    /* per row: calls, share of wall time, stack high-water / size (or the
+     * longest pass for the GUI thread, whose stack is not ours).
+     * The QSK row is a latency: break-ins, mean and worst time to silence */
+    canvas_set_font(canvas, FontSecondary);
+    int y = 22;
+    for(size_t i = 0; i < MorseCodeProfileCount; i++, y += 8) {
+        MorseCodeProfileStats st;
+        morse_code_profile_get(app->profile, i, &st);
+
+        canvas_draw_str(canvas, 4, y, morse_code_profile_name(i));
+        format_count(line, sizeof(line), st.calls);
+        canvas_draw_str_aligned(canvas, 52, y, AlignRight, AlignBottom, line);
+
+        if(i == MorseCodeProfileBreakIn) {
+            const uint32_t mean_us = st.calls ? (uint32_t)(st.busy_us / st.calls) : 0;
+            snprintf(
+                line,
+                sizeof(line),
+                "%lu.%lums",
+                (unsigned long)(mean_us / 1000),
+                (unsigned long)(mean_us / 100 % 10));
+            canvas_draw_str_aligned(canvas, 84, y, AlignRight, AlignBottom, line);
+            snprintf(
+                line,
+                sizeof(line),
+                "%lu.%lums",
+                (unsigned long)(st.max_us / 1000),
+                (unsigned long)(st.max_us / 100 % 10));
+            canvas_draw_str_aligned(canvas, 124, y, AlignRight, AlignBottom, line);
+            continue;
+        }
+
+        /* busy_us / (uptime_ms * 1000) in tenths of a percent */
+        const uint32_t permille = uptime_ms ? (uint32_t)(st.busy_us / uptime_ms) : 0;
+        snprintf(
+            line,
+            sizeof(line),
+            "%lu.%lu%%",
+            (unsigned long)(permille / 10),
+            (unsigned long)(permille % 10));
+        canvas_draw_str_aligned(canvas, 84, y, AlignRight, AlignBottom, line);
+
+        if(st.stack_size)
+            snprintf(
+                line,
+                sizeof(line),
+                "%lu/%lu",
+                (unsigned long)st.stack_used,
+                (unsigned long)st.stack_size);
+        else
+            snprintf(line, sizeof(line), "%lums", (unsigned long)(st.max_us / 1000));
+        canvas_draw_str_aligned(canvas, 124, y, AlignRight, AlignBottom, line);
+    }
+
+    canvas_draw_str(canvas, 4, 63, m->diag_note ? m->diag_note : "OK: save to SD");
+}
+#endif
+
+/* =============
+ *  UI: keying strip
+ * ============= */
+
+static void draw_strip(Canvas* canvas, MorseCode* app) {
+    uint8_t xbm[(STRIP_W / 8) * STRIP_H];
+    uint8_t* row = xbm;
+    MorseCodeWorkerStatus st;
+    morse_code_worker_get_status(app->worker, &st);
+    /* the key just went down, or key-down samples are still scrolling */
+    app->live_redraw = morse_code_worker_get_timeline(app->worker, row, STRIP_W) || st.keying;
+    app->live_every = 1;
+    for(size_t r = 1; r < STRIP_H - 1; r++) memcpy(xbm + r * (STRIP_W / 8), row, STRIP_W / 8);
+    memset(xbm + (STRIP_H - 1) * (STRIP_W / 8), 0xFF, STRIP_W / 8);
+    canvas_draw_xbm(canvas, STRIP_X, STRIP_Y, STRIP_W, STRIP_H, xbm);
+}
+
+static void strip_timer_cb(void* ctx) {
+    MorseCode* app = ctx;
+    view_port_update(app->view_port);
 }
 
 /* =============
@@ -159,9 +414,42 @@ static void draw_lookup(Canvas* canvas, MorseCodeModel* m) {
 
 static void worker_ui_cb(FuriString* words, void* ctx) {
     MorseCode* app = ctx;
+#if MORSE_CODE_FEATURE_TRAINING
+    bool group_copied = false;
+#endif
     if(furi_mutex_acquire(app->model_mutex, FuriWaitForever) != FuriStatusOk) return;
-    furi_string_set(app->model->words, words);
+    MorseCodeModel* m = app->model;
+    furi_string_set(m->words, words);
+
+#if MORSE_CODE_FEATURE_TRAINING
+    if(m->state == STATE_TRAIN && app->training) {
+        /* text shrank: cleared for a new group or wrapped by the worker */
+        const size_t size = furi_string_size(words);
+        if(size < m->train_fed) m->train_fed = 0;
+        const uint32_t now = furi_get_tick();
+        for(; m->train_fed < size; m->train_fed++) {
+            const char c = furi_string_get_char(words, m->train_fed);
+            if(morse_code_training_feed(app->training, c, now) && !m->train_posted) {
+                m->train_posted = true;
+                group_copied = true;
+            }
+        }
+    }
+#endif
     furi_mutex_release(app->model_mutex);
+
+#if MORSE_CODE_FEATURE_TRAINING
+    if(group_copied) {
+        /* scoring + next playback run on the UI thread, not the keying thread */
+        const MorseCodeEvent ev = {.type = EventTypeTrainingCopied};
+        if(furi_message_queue_put(app->event_queue, &ev, 0) != FuriStatusOk) {
+            /* queue full: un-latch so the next character (or Skip) posts again */
+            furi_check(furi_mutex_acquire(app->model_mutex, FuriWaitForever) == FuriStatusOk);
+            app->model->train_posted = false;
+            furi_mutex_release(app->model_mutex);
+        }
+    }
+#endif
     view_port_update(app->view_port);
 }
 
@@ -169,10 +457,20 @@ static void worker_ui_cb(FuriString* words, void* ctx) {
  *  Viewport
  * ============= */
 
-static void render_callback(Canvas* canvas, void* ctx) {
-    MorseCode* app = ctx;
+static void render_draw(Canvas* canvas, MorseCode* app) {
+
+    if(!app->first_frame_done) {
+        app->first_frame_ms = furi_get_tick() - app->launch_tick;
+        app->first_frame_done = true;
+        FURI_LOG_I(
+            TAG,
+            "Build %s: launch to first frame %lu ms",
+            MORSE_CODE_BUILD_NAME,
+            (unsigned long)app->first_frame_ms);
+    }
 
     canvas_clear(canvas);
+    app->live_redraw = false; /* screens showing live state re-arm this */
 
     furi_check(furi_mutex_acquire(app->model_mutex, FuriWaitForever) == FuriStatusOk);
     MorseCodeModel* m = app->model;
@@ -182,17 +480,36 @@ static void render_callback(Canvas* canvas, void* ctx) {
         furi_mutex_release(app->model_mutex);
         return;
     }
+#if MORSE_CODE_FEATURE_LOOKUP
     if(m->state == STATE_LOOKUP) {
         draw_lookup(canvas, m);
         furi_mutex_release(app->model_mutex);
         return;
     }
+#endif
+#if MORSE_CODE_FEATURE_TRAINING
+    if(m->state == STATE_TRAIN && app->training) {
+        draw_training(canvas, app, m);
+        furi_mutex_release(app->model_mutex);
+        return;
+    }
+#endif
+#if MORSE_CODE_FEATURE_PROFILE
+    if(m->state == STATE_DIAG) {
+        draw_diag(canvas, app, m);
+        furi_mutex_release(app->model_mutex);
+        return;
+    }
+#endif
 
     /* STATE_MAIN */
     canvas_set_font(canvas, FontPrimary);
     elements_multiline_text_aligned(
         canvas, 64, 30, AlignCenter, AlignCenter, furi_string_get_cstr(m->words));
 
+    /* last few seconds of key state */
+    draw_strip(canvas, app);
+
     /* volume bar */
     const uint8_t vol_bar_x_pos = 124, vol_bar_y_pos = 0;
     const uint8_t volume_h = (uint8_t)((64 / (5 - 1)) * m->volume);
@@ -210,9 +527,136 @@ static void render_callback(Canvas* canvas, void* ctx) {
     furi_mutex_release(app->model_mutex);
 }
 
+static void render_callback(Canvas* canvas, void* ctx) {
+    MorseCode* app = ctx;
+    const uint32_t span = morse_code_profile_begin();
+    render_draw(canvas, app);
+    /* no periodic wakeups while nothing on screen moves: once a frame shows
+     * no live state the timer is left to lapse */
+    if(app->live_redraw)
+        furi_timer_start(app->strip_timer, furi_ms_to_ticks(STRIP_REFRESH_MS * app->live_every));
+    morse_code_profile_end(app->profile, MorseCodeProfileRender, span);
+}
+
 static void input_callback(InputEvent* e, void* ctx) {
     MorseCode* app = ctx;
-    furi_message_queue_put(app->input_queue, e, FuriWaitForever);
+    const MorseCodeEvent ev = {.type = EventTypeInput, .input = *e};
+    furi_message_queue_put(app->event_queue, &ev, FuriWaitForever);
+}
+
+#if MORSE_CODE_FEATURE_TRAINING
+/* =============
+ *  Training flow (UI thread)
+ * ============= */
+
+/* score the copied group (unless `first`) and start the pre-compiled next one */
+static void training_next_group(MorseCode* app, bool first) {
+    MorseCodeWorkerStatus st;
+    morse_code_worker_get_status(app->worker, &st);
+    /* copied under break-in before its playback ended: playback_end_tick
+     * still belongs to the previous group, so the group ends now */
+    uint32_t group_end = st.playback_end_tick;
+    if(st.playback_active) {
+        morse_code_worker_cancel_playback(app->worker);
+        group_end = furi_get_tick();
+    }
+
+    furi_check(furi_mutex_acquire(app->model_mutex, FuriWaitForever) == FuriStatusOk);
+    MorseCodeModel* m = app->model;
+    if(m->state != STATE_TRAIN || !app->training) {
+        furi_mutex_release(app->model_mutex);
+        return;
+    }
+    if(!first) {
+        morse_code_training_score(app->training, group_end, &m->train_result);
+        m->train_has_result = true;
+        morse_code_training_advance(app->training);
+    }
+    m->train_posted = false;
+    /* current slot is only rewritten by advance(), which runs on this thread */
+    size_t count;
+    const uint8_t* program = morse_code_training_program(app->training, &count);
+    furi_mutex_release(app->model_mutex);
+
+    morse_code_worker_set_text_cstr(app->worker, "");
+    morse_code_worker_playback_program_async(app->worker, program, count, true);
+
+    /* compile the group after this one while it plays */
+    furi_check(furi_mutex_acquire(app->model_mutex, FuriWaitForever) == FuriStatusOk);
+    morse_code_training_prepare_next(app->training);
+    furi_mutex_release(app->model_mutex);
+}
+
+static void training_enter(MorseCode* app) {
+    if(!app->training) {
+        /* stats load touches storage: keep it outside the model lock */
+        MorseCodeTraining* training = morse_code_training_alloc();
+        furi_check(furi_mutex_acquire(app->model_mutex, FuriWaitForever) == FuriStatusOk);
+        app->training = training;
+        furi_mutex_release(app->model_mutex);
+    }
+
+    furi_check(furi_mutex_acquire(app->model_mutex, FuriWaitForever) == FuriStatusOk);
+    morse_code_training_start(app->training);
+    app->model->train_fed = 0;
+    app->model->train_has_result = false;
+    const uint32_t gap = morse_code_training_get_gap(app->training);
+    furi_mutex_release(app->model_mutex);
+
+    morse_code_worker_set_gap_delta(app->worker, gap);
+    training_next_group(app, true);
+}
+
+static void training_leave(MorseCode* app, const char* saved_words) {
+    morse_code_worker_cancel_playback(app->worker);
+    morse_code_worker_set_gap_delta(app->worker, 0);
+    morse_code_worker_set_text_cstr(app->worker, saved_words);
+    morse_code_training_save(app->training);
+}
+#endif
+
+/* =============
+ *  Keying parameters (UI thread, model lock held)
+ * ============= */
+
+/* Up/Down/Left/Right on the keying screens. Also used while playback runs:
+ * it picks the new values up from its next element. True if handled */
+static bool keying_param_key(MorseCode* app, MorseCodeModel* m, AppState state, InputKey key) {
+    if(state == STATE_MAIN) {
+        switch(key) {
+        case InputKeyUp:
+            if(m->volume < 4) m->volume++;
+            return true;
+        case InputKeyDown:
+            if(m->volume > 0) m->volume--;
+            return true;
+        case InputKeyLeft:
+            if(m->dit_delta >= MORSE_CODE_SETTINGS_DIT_MIN + 10) m->dit_delta -= 10;
+            return true;
+        case InputKeyRight:
+            if(m->dit_delta + 10 <= MORSE_CODE_SETTINGS_DIT_MAX) m->dit_delta += 10;
+            return true;
+        default:
+            return false;
+        }
+    }
+#if MORSE_CODE_FEATURE_TRAINING
+    if(state == STATE_TRAIN && app->training) {
+        /* Up/Down: Farnsworth gap */
+        const uint32_t gap = morse_code_training_get_gap(app->training);
+        if(key == InputKeyUp) {
+            morse_code_training_set_gap(app->training, gap + TRAIN_GAP_STEP);
+            return true;
+        }
+        if(key == InputKeyDown) {
+            if(gap >= TRAIN_GAP_STEP) morse_code_training_set_gap(app->training, gap - TRAIN_GAP_STEP);
+            return true;
+        }
+    }
+#else
+    UNUSED(app);
+#endif
+    return false;
 }
 
 /* =============
@@ -221,22 +665,55 @@ static void input_callback(InputEvent* e, void* ctx) {
 
 static MorseCode* morse_code_alloc(void) {
     MorseCode* inst = malloc(sizeof(MorseCode));
+    inst->launch_tick = furi_get_tick();
+    inst->first_frame_ms = 0;
+    inst->first_frame_done = false;
+
+    morse_code_settings_load(&inst->settings);
 
     inst->model = malloc(sizeof(MorseCodeModel));
     inst->model->words = furi_string_alloc_set_str("");
-    inst->model->volume = 3;
-    inst->model->dit_delta = 150;
+    inst->model->volume = inst->settings.volume;
+    inst->model->dit_delta = inst->settings.dit_delta;
     inst->model->state = STATE_MAIN;
     inst->model->menu_index = 0;
-    inst->model->lookup_index = 0;
     inst->model->back_guard = false;
+    inst->model->log_edges = inst->settings.log_edges;
+    inst->model->qsk = inst->settings.qsk;
+#if MORSE_CODE_FEATURE_LOOKUP
+    inst->model->lookup_index = 0;
     inst->model->lookup_ok_guard = false;
+#endif
+#if MORSE_CODE_FEATURE_TRAINING
+    inst->model->train_saved = furi_string_alloc();
+    inst->model->train_fed = 0;
+    inst->model->train_posted = false;
+    inst->model->train_has_result = false;
+#endif
+#if MORSE_CODE_FEATURE_PROFILE
+    inst->model->diag_note = NULL;
+#endif
 
     inst->model_mutex = furi_mutex_alloc(FuriMutexTypeNormal);
-    inst->input_queue = furi_message_queue_alloc(8, sizeof(InputEvent));
+    inst->event_queue = furi_message_queue_alloc(8, sizeof(MorseCodeEvent));
+
+    inst->profile = morse_code_profile_alloc();
+    morse_code_profile_set_stack(inst->profile, MorseCodeProfileEvents, APP_STACK_SIZE);
 
     inst->worker = morse_code_worker_alloc();
     morse_code_worker_set_callback(inst->worker, worker_ui_cb, inst);
+    morse_code_worker_set_profile(inst->worker, inst->profile);
+
+    inst->log = morse_code_log_alloc();
+    morse_code_log_set_edges(inst->log, inst->model->log_edges);
+    morse_code_worker_set_log(inst->worker, inst->log);
+
+#if MORSE_CODE_FEATURE_TRAINING
+    inst->training = NULL;
+#endif
+    inst->live_redraw = false;
+    inst->live_every = 1;
+    inst->strip_timer = furi_timer_alloc(strip_timer_cb, FuriTimerTypeOnce, inst);
 
     inst->view_port = view_port_alloc();
     view_port_draw_callback_set(inst->view_port, render_callback, inst);
@@ -247,17 +724,42 @@ static MorseCode* morse_code_alloc(void) {
     return inst;
 }
 
+static void morse_code_save_settings(MorseCode* inst) {
+    MorseCodeSettings now = inst->settings;
+    now.volume = inst->model->volume;
+    now.dit_delta = inst->model->dit_delta;
+    now.log_edges = inst->model->log_edges;
+    now.qsk = inst->model->qsk;
+    if(now.volume == inst->settings.volume && now.dit_delta == inst->settings.dit_delta &&
+       now.log_edges == inst->settings.log_edges && now.qsk == inst->settings.qsk)
+        return;
+    if(morse_code_settings_save(&now)) inst->settings = now;
+}
+
 static void morse_code_free(MorseCode* inst) {
+    morse_code_save_settings(inst);
+
+    /* no more frames to re-arm the timer, then no more timer to update them */
     gui_remove_view_port(inst->gui, inst->view_port);
     furi_record_close(RECORD_GUI);
+    furi_timer_stop(inst->strip_timer);
+    furi_timer_free(inst->strip_timer);
     view_port_free(inst->view_port);
 
     morse_code_worker_free(inst->worker);
+    morse_code_log_free(inst->log); /* after the worker: nothing logs past this */
+#if MORSE_CODE_FEATURE_TRAINING
+    if(inst->training) morse_code_training_free(inst->training);
+#endif
+    morse_code_profile_free(inst->profile); /* after the worker and the view port */
 
-    furi_message_queue_free(inst->input_queue);
+    furi_message_queue_free(inst->event_queue);
     furi_mutex_free(inst->model_mutex);
 
     furi_string_free(inst->model->words);
+#if MORSE_CODE_FEATURE_TRAINING
+    furi_string_free(inst->model->train_saved);
+#endif
     free(inst->model);
     free(inst);
 }
@@ -268,19 +770,56 @@ static void morse_code_free(MorseCode* inst) {
 
 int32_t morse_code_plus_app(void) {
     MorseCode* app = morse_code_alloc();
-    InputEvent in;
+    MorseCodeEvent ev;
 
     morse_code_worker_start(app->worker);
     morse_code_worker_set_volume(app->worker, MORSE_CODE_VOLUMES[app->model->volume]);
     morse_code_worker_set_dit_delta(app->worker, app->model->dit_delta);
+#if MORSE_CODE_FEATURE_QSK
+    morse_code_worker_set_qsk(app->worker, (MorseCodeQsk)app->model->qsk);
+#endif
+
+    uint32_t span = 0;
+    for(bool first = true;; first = false) {
+        /* an event's section runs until the loop comes back for the next one */
+        if(!first) morse_code_profile_end(app->profile, MorseCodeProfileEvents, span);
+        if(furi_message_queue_get(app->event_queue, &ev, FuriWaitForever) != FuriStatusOk) break;
+        span = morse_code_profile_begin();
+
+#if MORSE_CODE_FEATURE_TRAINING
+        if(ev.type == EventTypeTrainingCopied) {
+            training_next_group(app, false);
+            view_port_update(app->view_port);
+            continue;
+        }
+#endif
+        const InputEvent in = ev.input;
 
-    while(furi_message_queue_get(app->input_queue, &in, FuriWaitForever) == FuriStatusOk) {
+#if MORSE_CODE_FEATURE_PLAYBACK
         bool start_playback = false;
         char playback_buf[128]; playback_buf[0] = '\0';
+#endif
 
         bool do_set_text = false;
         char set_text_buf[128]; set_text_buf[0] = '\0';
 
+#if MORSE_CODE_FEATURE_LOG
+        bool do_load_last = false;
+#endif
+#if MORSE_CODE_FEATURE_PROFILE
+        bool do_diag_dump = false;
+#endif
+#if MORSE_CODE_FEATURE_QSK
+        bool do_set_qsk = false;
+#endif
+
+#if MORSE_CODE_FEATURE_TRAINING
+        bool do_train_enter = false;
+        bool do_train_leave = false;
+        bool do_train_next = false;
+        bool do_train_replay = false;
+#endif
+
         furi_check(furi_mutex_acquire(app->model_mutex, FuriWaitForever) == FuriStatusOk);
         MorseCodeModel* m = app->model;
         const AppState state_now = m->state;
@@ -300,8 +839,32 @@ int32_t morse_code_plus_app(void) {
                 view_port_update(app->view_port);
                 continue;
             }
-            /* While playing back, ignore other UI changes */
+            /* Dit / volume / training gap still apply, from the next element */
+            if(in.type == InputTypePress) keying_param_key(app, m, state_now, in.key);
+            const uint8_t volume_idx = m->volume;
+            const uint32_t dit = m->dit_delta;
+#if MORSE_CODE_FEATURE_TRAINING
+            const bool train_gap_live = (state_now == STATE_TRAIN && app->training);
+            const uint32_t train_gap =
+                train_gap_live ? morse_code_training_get_gap(app->training) : 0;
+#endif
+#if MORSE_CODE_FEATURE_QSK
+            /* Break-in: OK keys over the playback, the worker pauses or ends it */
+            const bool keying_state = (state_now == STATE_MAIN || state_now == STATE_TRAIN);
+            const bool break_in = keying_state && m->qsk != MorseCodeQskOff && in.key == InputKeyOk;
+#endif
             furi_mutex_release(app->model_mutex);
+
+            morse_code_worker_set_volume(app->worker, MORSE_CODE_VOLUMES[volume_idx]);
+            morse_code_worker_set_dit_delta(app->worker, dit);
+#if MORSE_CODE_FEATURE_TRAINING
+            if(train_gap_live) morse_code_worker_set_gap_delta(app->worker, train_gap);
+#endif
+#if MORSE_CODE_FEATURE_QSK
+            if(break_in && in.type == InputTypePress) morse_code_worker_play(app->worker, true);
+            if(break_in && in.type == InputTypeRelease) morse_code_worker_play(app->worker, false);
+#endif
+            /* Everything else waits until playback ends */
             view_port_update(app->view_port);
             continue;
         }
@@ -316,36 +879,71 @@ int32_t morse_code_plus_app(void) {
         if(state_now == STATE_MENU) {
             if(in.type == InputTypePress) {
                 if(in.key == InputKeyUp) {
-                    m->menu_index = (m->menu_index == 0) ? 3 : (uint8_t)(m->menu_index - 1);
+                    m->menu_index = (m->menu_index == 0) ? (uint8_t)(MENU_COUNT - 1)
+                                                         : (uint8_t)(m->menu_index - 1);
                 } else if(in.key == InputKeyDown) {
-                    m->menu_index = (uint8_t)((m->menu_index + 1) % 4);
+                    m->menu_index = (uint8_t)((m->menu_index + 1) % MENU_COUNT);
                 } else if(in.key == InputKeyBack || in.key == InputKeyLeft) {
                     m->state = STATE_MAIN;
                     m->back_guard = true;
                 } else if(in.key == InputKeyOk) {
                     switch(m->menu_index) {
-                        case 0: /* Erase */
+                        case MENU_ERASE:
                             furi_string_reset(m->words);
                             set_text_buf[0] = '\0';
                             do_set_text = true;
                             m->state = STATE_MAIN;
                             break;
-                        case 1: /* Lookup */
+#if MORSE_CODE_FEATURE_LOOKUP
+                        case MENU_LOOKUP:
                             m->state = STATE_LOOKUP;
                             m->lookup_ok_guard = true;
                             break;
-                        case 2: /* Playback */
+#endif
+#if MORSE_CODE_FEATURE_PLAYBACK
+                        case MENU_PLAYBACK:
                             strlcpy(playback_buf, furi_string_get_cstr(m->words), sizeof(playback_buf));
                             start_playback = true;           /* async */
                             m->state = STATE_MAIN;
                             break;
-                        case 3: /* Exit */
+#endif
+#if MORSE_CODE_FEATURE_TRAINING
+                        case MENU_TRAINING:
+                            furi_string_set(m->train_saved, m->words);
+                            m->state = STATE_TRAIN;
+                            do_train_enter = true;
+                            break;
+#endif
+#if MORSE_CODE_FEATURE_LOG
+                        case MENU_LOAD_LAST: /* previous session -> transcript */
+                            do_load_last = true;
+                            m->state = STATE_MAIN;
+                            break;
+                        case MENU_LOG_EDGES:
+                            m->log_edges = !m->log_edges;
+                            morse_code_log_set_edges(app->log, m->log_edges);
+                            break;
+#endif
+#if MORSE_CODE_FEATURE_QSK
+                        case MENU_BREAK_IN:
+                            m->qsk = (uint8_t)((m->qsk + 1) % MorseCodeQskCount);
+                            do_set_qsk = true;
+                            break;
+#endif
+#if MORSE_CODE_FEATURE_PROFILE
+                        case MENU_DIAGNOSTICS:
+                            m->diag_note = NULL;
+                            m->state = STATE_DIAG;
+                            break;
+#endif
+                        case MENU_EXIT:
                             furi_mutex_release(app->model_mutex);
                             goto exit_loop;
                     }
                 }
             }
 
+#if MORSE_CODE_FEATURE_LOOKUP
         } else if(state_now == STATE_LOOKUP) {
             /* Swallow lingering OK from entering Lookup until OK is released */
             if(m->lookup_ok_guard && in.key == InputKeyOk) {
@@ -364,11 +962,13 @@ int32_t morse_code_plus_app(void) {
                 } else if(in.key == InputKeyLeft || in.key == InputKeyBack) {
                     m->state = STATE_MENU;
                     m->back_guard = (in.key == InputKeyBack);
+#if MORSE_CODE_FEATURE_PLAYBACK
                 } else if(in.key == InputKeyRight) {
                     char sym = LOOKUP_ALPHABET[m->lookup_index];
                     playback_buf[0] = sym;
                     playback_buf[1] = '\0';
                     start_playback = true;                 /* async single char */
+#endif
                 }
             }
             if(in.key == InputKeyOk && in.type == InputTypeShort && !m->lookup_ok_guard) {
@@ -378,48 +978,125 @@ int32_t morse_code_plus_app(void) {
                 do_set_text = true;
             }
 
+#endif
+#if MORSE_CODE_FEATURE_TRAINING
+        } else if(state_now == STATE_TRAIN) {
+            if(in.key == InputKeyBack && in.type == InputTypeShort) {
+                strlcpy(set_text_buf, furi_string_get_cstr(m->train_saved), sizeof(set_text_buf));
+                m->state = STATE_MENU;
+                do_train_leave = true;
+            } else if(in.type == InputTypePress && app->training) {
+                /* Up/Down: Farnsworth gap, Left: replay group, Right: score what was copied */
+                if(keying_param_key(app, m, state_now, in.key)) {
+                    /* gap published below */
+                } else if(in.key == InputKeyLeft) {
+                    do_train_replay = true;
+                } else if(in.key == InputKeyRight && !m->train_posted) {
+                    m->train_posted = true;
+                    do_train_next = true;
+                }
+            }
+
+#endif
+#if MORSE_CODE_FEATURE_PROFILE
+        } else if(state_now == STATE_DIAG) {
+            if(in.type == InputTypePress) {
+                if(in.key == InputKeyBack || in.key == InputKeyLeft) {
+                    m->state = STATE_MENU;
+                    m->back_guard = (in.key == InputKeyBack);
+                } else if(in.key == InputKeyOk) {
+                    do_diag_dump = true;
+                }
+            }
+
+#endif
         } else { /* STATE_MAIN */
             if(in.key == InputKeyBack && in.type == InputTypeShort) {
                 m->state = STATE_MENU;
                 m->menu_index = 0;
             } else if(in.key == InputKeyOk) {
                 /* handled below via worker_play on press/release */
-            } else if(in.key == InputKeyUp && in.type == InputTypePress) {
-                if(m->volume < 4) m->volume++;
-            } else if(in.key == InputKeyDown && in.type == InputTypePress) {
-                if(m->volume > 0) m->volume--;
-            } else if(in.key == InputKeyLeft && in.type == InputTypePress) {
-                if(m->dit_delta > 10) m->dit_delta -= 10;
-            } else if(in.key == InputKeyRight && in.type == InputTypePress) {
-                if(m->dit_delta >= 10) m->dit_delta += 10;
+            } else if(in.type == InputTypePress) {
+                keying_param_key(app, m, state_now, in.key); /* volume, Dit */
             }
         }
 
-        /* capture params + ok states for audio (main only) */
+        /* capture params + ok states for audio (main and training copy) */
         const uint8_t volume_idx = m->volume;
         const uint32_t dit = m->dit_delta;
+#if MORSE_CODE_FEATURE_QSK
+        const MorseCodeQsk qsk = (MorseCodeQsk)m->qsk;
+#endif
+        const bool keying_state = (state_now == STATE_MAIN || state_now == STATE_TRAIN);
         const bool ok_press_main =
-            (state_now == STATE_MAIN && in.key == InputKeyOk && in.type == InputTypePress);
+            (keying_state && in.key == InputKeyOk && in.type == InputTypePress);
         const bool ok_release_main =
-            (state_now == STATE_MAIN && in.key == InputKeyOk && in.type == InputTypeRelease);
+            (keying_state && in.key == InputKeyOk && in.type == InputTypeRelease);
+#if MORSE_CODE_FEATURE_TRAINING
+        const uint32_t train_gap =
+            app->training ? morse_code_training_get_gap(app->training) : 0;
+        size_t train_count = 0;
+        const uint8_t* train_program =
+            app->training ? morse_code_training_program(app->training, &train_count) : NULL;
+#endif
 
         furi_mutex_release(app->model_mutex);
 
         /* ---- worker calls AFTER unlock ---- */
         morse_code_worker_set_volume(app->worker, MORSE_CODE_VOLUMES[volume_idx]);
         morse_code_worker_set_dit_delta(app->worker, dit);
+#if MORSE_CODE_FEATURE_TRAINING
+        if(state_now == STATE_TRAIN && !do_train_leave)
+            morse_code_worker_set_gap_delta(app->worker, train_gap);
+#endif
+
+#if MORSE_CODE_FEATURE_QSK
+        if(do_set_qsk) morse_code_worker_set_qsk(app->worker, qsk);
+#endif
 
         if(ok_press_main)  morse_code_worker_play(app->worker, true);
         if(ok_release_main) morse_code_worker_play(app->worker, false);
 
+#if MORSE_CODE_FEATURE_PLAYBACK
         if(start_playback && playback_buf[0] != '\0') {
             morse_code_worker_playback_async(app->worker, playback_buf, true);
         }
+#endif
 
         if(do_set_text) {
             morse_code_worker_set_text_cstr(app->worker, set_text_buf);
         }
 
+#if MORSE_CODE_FEATURE_TRAINING
+        if(do_train_enter) training_enter(app);
+        if(do_train_leave) training_leave(app, set_text_buf);
+        if(do_train_next) training_next_group(app, false);
+        if(do_train_replay && train_program) {
+            /* copy so far is kept: the replay just helps finish it */
+            morse_code_worker_playback_program_async(app->worker, train_program, train_count, true);
+        }
+#endif
+
+#if MORSE_CODE_FEATURE_LOG
+        if(do_load_last) {
+            /* storage access stays outside the model lock */
+            FuriString* last = furi_string_alloc();
+            if(morse_code_log_load_last(app->log, last, TRANSCRIPT_MAX)) {
+                morse_code_worker_set_text_cstr(app->worker, furi_string_get_cstr(last));
+            }
+            furi_string_free(last);
+        }
+#endif
+
+#if MORSE_CODE_FEATURE_PROFILE
+        if(do_diag_dump) {
+            const bool saved = morse_code_profile_dump(app->profile);
+            furi_check(furi_mutex_acquire(app->model_mutex, FuriWaitForever) == FuriStatusOk);
+            app->model->diag_note = saved ? "Saved profile.txt" : "Save failed";
+            furi_mutex_release(app->model_mutex);
+        }
+#endif
+
         view_port_update(app->view_port);
     }
 
@@ -0,0 +1,176 @@
+#include "morse_code_profile.h"
+
+#if MORSE_CODE_FEATURE_PROFILE
+#include <furi.h>
+#include <furi_hal.h>
+#include <storage/storage.h>
+#include <lib/flipper_format/flipper_format.h>
+#include <stdatomic.h>
+
+#define TAG "MorseCodeProfile"
+
+#define MORSE_CODE_PROFILE_PATH APP_DATA_PATH("profile.txt")
+#define MORSE_CODE_PROFILE_FILETYPE "Morse Code Plus Profile"
+#define MORSE_CODE_PROFILE_VERSION 1
+
+/* high-water sampling scans the stack: keep it off most passes */
+#define MORSE_CODE_PROFILE_STACK_EVERY 64
+
+typedef struct {
+    atomic_uint calls;
+    atomic_uint busy_us;
+    atomic_uint max_us;
+    atomic_uint stack_size;
+    atomic_uint stack_free_min; /* UINT32_MAX until sampled */
+    uint32_t carry;             /* writer only: cycles short of a whole us */
+} MorseCodeProfileCounter;
+
+struct MorseCodeProfile {
+    uint32_t start_tick;
+    uint32_t cycles_per_us;
+    MorseCodeProfileCounter counters[MorseCodeProfileCount];
+};
+
+/* Diagnostics row labels, also the keys in profile.txt */
+static const char* const morse_code_profile_names[MorseCodeProfileCount] = {
+    "Key",
+    "Play",
+    "App",
+    "Draw",
+    "QSK",
+};
+
+MorseCodeProfile* morse_code_profile_alloc(void) {
+    MorseCodeProfile* profile = malloc(sizeof(MorseCodeProfile));
+    profile->start_tick = furi_get_tick();
+    profile->cycles_per_us = furi_hal_cortex_instructions_per_microsecond();
+    for(size_t i = 0; i < MorseCodeProfileCount; i++) {
+        MorseCodeProfileCounter* c = &profile->counters[i];
+        atomic_init(&c->calls, 0u);
+        atomic_init(&c->busy_us, 0u);
+        atomic_init(&c->max_us, 0u);
+        atomic_init(&c->stack_size, 0u);
+        atomic_init(&c->stack_free_min, UINT32_MAX);
+        c->carry = 0;
+    }
+    return profile;
+}
+
+void morse_code_profile_free(MorseCodeProfile* profile) {
+    furi_assert(profile);
+    free(profile);
+}
+
+void morse_code_profile_set_stack(
+    MorseCodeProfile* profile, MorseCodeProfileSection section, uint32_t stack_size) {
+    furi_assert(profile);
+    furi_assert(section < MorseCodeProfileCount);
+    atomic_store_explicit(&profile->counters[section].stack_size, stack_size, memory_order_relaxed);
+}
+
+uint32_t morse_code_profile_begin(void) {
+    /* DWT cycle counter: free-running, wraps after ~67 s at 64 MHz */
+    return furi_hal_cortex_timer_get(0).start;
+}
+
+void morse_code_profile_sample_stack(MorseCodeProfile* profile, MorseCodeProfileSection section) {
+    furi_assert(profile);
+    MorseCodeProfileCounter* c = &profile->counters[section];
+    if(!atomic_load_explicit(&c->stack_size, memory_order_relaxed)) return;
+    const uint32_t free_now = furi_thread_get_stack_space(furi_thread_get_current_id());
+    if(free_now < atomic_load_explicit(&c->stack_free_min, memory_order_relaxed))
+        atomic_store_explicit(&c->stack_free_min, free_now, memory_order_relaxed);
+}
+
+void morse_code_profile_end(
+    MorseCodeProfile* profile, MorseCodeProfileSection section, uint32_t begin) {
+    furi_assert(profile);
+    furi_assert(section < MorseCodeProfileCount);
+    MorseCodeProfileCounter* c = &profile->counters[section];
+
+    /* unsigned difference survives one counter wrap */
+    const uint32_t cycles = morse_code_profile_begin() - begin;
+    const uint32_t us = cycles / profile->cycles_per_us;
+    /* short passes are a fraction of a us: carry the remainder over */
+    c->carry += cycles % profile->cycles_per_us;
+    const uint32_t whole = us + c->carry / profile->cycles_per_us;
+    c->carry %= profile->cycles_per_us;
+
+    const uint32_t calls = atomic_load_explicit(&c->calls, memory_order_relaxed) + 1;
+    atomic_store_explicit(&c->calls, calls, memory_order_relaxed);
+    atomic_store_explicit(
+        &c->busy_us,
+        atomic_load_explicit(&c->busy_us, memory_order_relaxed) + whole,
+        memory_order_relaxed);
+    if(us > atomic_load_explicit(&c->max_us, memory_order_relaxed))
+        atomic_store_explicit(&c->max_us, us, memory_order_relaxed);
+
+    if(calls % MORSE_CODE_PROFILE_STACK_EVERY == 1) morse_code_profile_sample_stack(profile, section);
+}
+
+void morse_code_profile_get(
+    MorseCodeProfile* profile, MorseCodeProfileSection section, MorseCodeProfileStats* stats) {
+    furi_assert(profile);
+    furi_assert(stats);
+    furi_assert(section < MorseCodeProfileCount);
+    MorseCodeProfileCounter* c = &profile->counters[section];
+    stats->calls = atomic_load_explicit(&c->calls, memory_order_relaxed);
+    stats->busy_us = atomic_load_explicit(&c->busy_us, memory_order_relaxed);
+    stats->max_us = atomic_load_explicit(&c->max_us, memory_order_relaxed);
+    stats->stack_size = atomic_load_explicit(&c->stack_size, memory_order_relaxed);
+    const uint32_t free_min = atomic_load_explicit(&c->stack_free_min, memory_order_relaxed);
+    stats->stack_used = (free_min == UINT32_MAX || free_min > stats->stack_size) ?
+                            0 :
+                            stats->stack_size - free_min;
+}
+
+uint32_t morse_code_profile_uptime_ms(MorseCodeProfile* profile) {
+    furi_assert(profile);
+    return furi_get_tick() - profile->start_tick;
+}
+
+const char* morse_code_profile_name(MorseCodeProfileSection section) {
+    return (section < MorseCodeProfileCount) ? morse_code_profile_names[section] : "?";
+}
+
+bool morse_code_profile_dump(MorseCodeProfile* profile) {
+    furi_assert(profile);
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    FlipperFormat* file = flipper_format_file_alloc(storage);
+
+    bool saved = false;
+    do {
+        if(!flipper_format_file_open_always(file, MORSE_CODE_PROFILE_PATH)) break;
+        if(!flipper_format_write_header_cstr(
+               file, MORSE_CODE_PROFILE_FILETYPE, MORSE_CODE_PROFILE_VERSION))
+            break;
+
+        const uint32_t timestamp = furi_hal_rtc_get_timestamp();
+        const uint32_t uptime = morse_code_profile_uptime_ms(profile);
+        const uint32_t heap[2] = {
+            (uint32_t)memmgr_get_free_heap(), (uint32_t)memmgr_get_minimum_free_heap()};
+        if(!flipper_format_write_uint32(file, "Timestamp", &timestamp, 1)) break;
+        if(!flipper_format_write_uint32(file, "Uptime", &uptime, 1)) break;
+        if(!flipper_format_write_comment_cstr(file, "Heap: free min_free (bytes)")) break;
+        if(!flipper_format_write_uint32(file, "Heap", heap, 2)) break;
+        if(!flipper_format_write_comment_cstr(
+               file, "<section>: calls busy_us max_us stack_size stack_used (bytes)"))
+            break;
+
+        bool written = true;
+        for(size_t i = 0; i < MorseCodeProfileCount && written; i++) {
+            MorseCodeProfileStats st;
+            morse_code_profile_get(profile, i, &st);
+            const uint32_t row[5] = {
+                st.calls, st.busy_us, st.max_us, st.stack_size, st.stack_used};
+            written = flipper_format_write_uint32(file, morse_code_profile_names[i], row, 5);
+        }
+        saved = written;
+    } while(false);
+
+    if(!saved) FURI_LOG_E(TAG, "Cannot write %s", MORSE_CODE_PROFILE_PATH);
+    flipper_format_free(file);
+    furi_record_close(RECORD_STORAGE);
+    return saved;
+}
+#endif
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "morse_code_config.h"
+
+/* Per-thread run-time counters: wakeups, busy time and stack high-water.
+ * Each section has a single writer thread, readers never lock. */
+
+typedef enum {
+    MorseCodeProfileDecode,   /* keying thread, one polling pass */
+    MorseCodeProfilePlayback, /* playback thread, between two sleeps */
+    MorseCodeProfileEvents,   /* app thread, one queued event */
+    MorseCodeProfileRender,   /* GUI thread, one frame */
+    MorseCodeProfileBreakIn,  /* key press during playback -> playback silent */
+    MorseCodeProfileCount,
+} MorseCodeProfileSection;
+
+typedef struct {
+    uint32_t calls;      /* wakeups / events / frames */
+    uint32_t busy_us;    /* wall time inside the section, preemption included */
+    uint32_t max_us;
+    uint32_t stack_size; /* 0: the thread is not ours */
+    uint32_t stack_used; /* high-water mark, 0 until sampled */
+} MorseCodeProfileStats;
+
+typedef struct MorseCodeProfile MorseCodeProfile;
+
+#if MORSE_CODE_FEATURE_PROFILE
+MorseCodeProfile* morse_code_profile_alloc(void);
+void morse_code_profile_free(MorseCodeProfile* profile);
+
+/* stack_size of the thread that runs the section, to sample its high-water */
+void morse_code_profile_set_stack(
+    MorseCodeProfile* profile, MorseCodeProfileSection section, uint32_t stack_size);
+
+/* cycle stamp for end(); call both from the section's own thread */
+uint32_t morse_code_profile_begin(void);
+void morse_code_profile_end(
+    MorseCodeProfile* profile, MorseCodeProfileSection section, uint32_t begin);
+/* sample the calling thread's stack now (end() also does it now and then) */
+void morse_code_profile_sample_stack(MorseCodeProfile* profile, MorseCodeProfileSection section);
+
+void morse_code_profile_get(
+    MorseCodeProfile* profile, MorseCodeProfileSection section, MorseCodeProfileStats* stats);
+uint32_t morse_code_profile_uptime_ms(MorseCodeProfile* profile);
+const char* morse_code_profile_name(MorseCodeProfileSection section);
+
+/* snapshot to APP_DATA_PATH("profile.txt"); touches storage */
+bool morse_code_profile_dump(MorseCodeProfile* profile);
+#else
+/* profiling compiled out: alloc gives NULL and the hooks vanish */
+static inline MorseCodeProfile* morse_code_profile_alloc(void) {
+    return NULL;
+}
+static inline void morse_code_profile_free(MorseCodeProfile* profile) {
+    (void)profile;
+}
+static inline void morse_code_profile_set_stack(
+    MorseCodeProfile* profile, MorseCodeProfileSection section, uint32_t stack_size) {
+    (void)profile;
+    (void)section;
+    (void)stack_size;
+}
+static inline uint32_t morse_code_profile_begin(void) {
+    return 0;
+}
+static inline void morse_code_profile_end(
+    MorseCodeProfile* profile, MorseCodeProfileSection section, uint32_t begin) {
+    (void)profile;
+    (void)section;
+    (void)begin;
+}
+static inline void
+    morse_code_profile_sample_stack(MorseCodeProfile* profile, MorseCodeProfileSection section) {
+    (void)profile;
+    (void)section;
+}
+#endif
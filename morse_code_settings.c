@@ -0,0 +1,52 @@
+#include "morse_code_settings.h"
+#include "morse_code_worker.h"
+#include <furi.h>
+#include <storage/storage.h>
+#include <toolbox/saved_struct.h>
+
+#define TAG "MorseCodeSettings"
+
+#define MORSE_CODE_SETTINGS_PATH APP_DATA_PATH("settings.bin")
+#define MORSE_CODE_SETTINGS_MAGIC 0x4D
+/* bump when MorseCodeSettings changes layout; old files then load as defaults */
+#define MORSE_CODE_SETTINGS_VERSION 2
+
+static void morse_code_settings_defaults(MorseCodeSettings* settings) {
+    settings->volume = MORSE_CODE_SETTINGS_VOLUME_DEFAULT;
+    settings->dit_delta = MORSE_CODE_SETTINGS_DIT_DEFAULT;
+    settings->log_edges = false;
+    settings->qsk = MorseCodeQskOff;
+}
+
+void morse_code_settings_load(MorseCodeSettings* settings) {
+    furi_assert(settings);
+    if(!saved_struct_load(
+           MORSE_CODE_SETTINGS_PATH,
+           settings,
+           sizeof(MorseCodeSettings),
+           MORSE_CODE_SETTINGS_MAGIC,
+           MORSE_CODE_SETTINGS_VERSION)) {
+        FURI_LOG_I(TAG, "Using defaults");
+        morse_code_settings_defaults(settings);
+        return;
+    }
+
+    /* the file is user-reachable on the SD card: clamp anything out of range */
+    if(settings->volume > 4) settings->volume = MORSE_CODE_SETTINGS_VOLUME_DEFAULT;
+    if(settings->dit_delta < MORSE_CODE_SETTINGS_DIT_MIN ||
+       settings->dit_delta > MORSE_CODE_SETTINGS_DIT_MAX)
+        settings->dit_delta = MORSE_CODE_SETTINGS_DIT_DEFAULT;
+    if(settings->qsk >= MorseCodeQskCount) settings->qsk = MorseCodeQskOff;
+}
+
+bool morse_code_settings_save(const MorseCodeSettings* settings) {
+    furi_assert(settings);
+    bool saved = saved_struct_save(
+        MORSE_CODE_SETTINGS_PATH,
+        settings,
+        sizeof(MorseCodeSettings),
+        MORSE_CODE_SETTINGS_MAGIC,
+        MORSE_CODE_SETTINGS_VERSION);
+    if(!saved) FURI_LOG_E(TAG, "Cannot save %s", MORSE_CODE_SETTINGS_PATH);
+    return saved;
+}
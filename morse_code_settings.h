@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Persisted user preferences (compact binary, versioned via saved_struct) */
+#define MORSE_CODE_SETTINGS_VOLUME_DEFAULT 3
+#define MORSE_CODE_SETTINGS_DIT_DEFAULT 150
+#define MORSE_CODE_SETTINGS_DIT_MIN 10   /* ms; load resets anything outside */
+#define MORSE_CODE_SETTINGS_DIT_MAX 2000 /* the MIN..MAX range to the default */
+
+typedef struct {
+    uint8_t volume;     /* 0..4 index into the app volume table */
+    uint32_t dit_delta; /* ms for dot */
+    bool log_edges;     /* session log also records raw key durations */
+    uint8_t qsk;        /* MorseCodeQsk: what keying during playback does */
+} MorseCodeSettings;
+
+/* fills defaults when the file is missing, corrupt or from another version */
+void morse_code_settings_load(MorseCodeSettings* settings);
+bool morse_code_settings_save(const MorseCodeSettings* settings);
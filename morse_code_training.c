@@ -0,0 +1,291 @@
+#include "morse_code_training.h"
+
+#if MORSE_CODE_FEATURE_TRAINING
+#include <furi_hal.h>
+#include <storage/storage.h>
+#include <toolbox/saved_struct.h>
+#include <string.h>
+
+#define TAG "MorseCodeTraining"
+
+#define MORSE_CODE_TRAINING_PATH APP_DATA_PATH("training.bin")
+#define MORSE_CODE_TRAINING_MAGIC 0x4B
+#define MORSE_CODE_TRAINING_VERSION 1
+
+/* halve a character's counters past this so recent groups dominate */
+#define MORSE_CODE_TRAINING_DECAY_AT 100
+/* Koch rule: unlock the next character at 90% on every known one */
+#define MORSE_CODE_TRAINING_LEVEL_ATTEMPTS 5
+#define MORSE_CODE_TRAINING_LEVEL_PERCENT 90
+
+/* Koch order, restricted to the characters the decoder knows */
+static const char koch_order[MORSE_CODE_TRAINING_CHARS] = {
+    'K','M','U','R','E','S','N','A','P','T','L','W',
+    'I','J','Z','F','O','Y','V','G','5','Q','9','2',
+    'H','3','8','B','4','7','C','1','D','6','0','X'
+};
+
+typedef struct {
+    uint16_t attempts;
+    uint16_t correct;
+    uint16_t latency_ms; /* smoothed copy latency */
+} MorseCodeTrainingCharStats;
+
+/* persisted as-is via saved_struct */
+typedef struct {
+    uint8_t level;
+    uint16_t gap_delta;
+    MorseCodeTrainingCharStats chars[MORSE_CODE_TRAINING_CHARS];
+} MorseCodeTrainingStats;
+
+typedef struct {
+    char text[MORSE_CODE_TRAINING_GROUP_LEN + 1];
+    uint8_t elements[MORSE_CODE_TRAINING_ELEMENTS_MAX]; /* MorseCodeElement */
+    size_t count;
+} MorseCodeTrainingGroup;
+
+struct MorseCodeTraining {
+    MorseCodeTrainingStats stats;
+    bool dirty;
+    uint32_t rng;
+
+    /* current is playing / being copied, next is ready behind it */
+    MorseCodeTrainingGroup groups[2];
+    uint8_t current;
+
+    char copied[MORSE_CODE_TRAINING_GROUP_LEN + 1];
+    uint32_t copied_tick[MORSE_CODE_TRAINING_GROUP_LEN];
+    uint8_t copied_len;
+};
+
+/* ---------- helpers ---------- */
+
+static uint32_t morse_code_training_rand(MorseCodeTraining* training) {
+    /* xorshift32: plenty for picking characters, a few cycles per call */
+    uint32_t x = training->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    training->rng = x;
+    return x;
+}
+
+static int morse_code_training_index(char c) {
+    for(int i = 0; i < MORSE_CODE_TRAINING_CHARS; i++) {
+        if(koch_order[i] == c) return i;
+    }
+    return -1;
+}
+
+/* weak characters (more misses) come up more often: weight 1..17 */
+static uint32_t morse_code_training_weight(const MorseCodeTrainingCharStats* st) {
+    const uint32_t misses = st->attempts - st->correct;
+    return 1 + (16 * (misses + 1)) / (st->attempts + 2u);
+}
+
+static void morse_code_training_generate(MorseCodeTraining* training, MorseCodeTrainingGroup* group) {
+    const uint8_t level = training->stats.level;
+    uint32_t weights[MORSE_CODE_TRAINING_CHARS];
+    uint32_t total = 0;
+    for(uint8_t i = 0; i < level; i++) {
+        weights[i] = morse_code_training_weight(&training->stats.chars[i]);
+        total += weights[i];
+    }
+
+    for(size_t n = 0; n < MORSE_CODE_TRAINING_GROUP_LEN; n++) {
+        uint32_t r = morse_code_training_rand(training) % total;
+        uint8_t i = 0;
+        while(r >= weights[i]) r -= weights[i++];
+        group->text[n] = koch_order[i];
+    }
+    group->text[MORSE_CODE_TRAINING_GROUP_LEN] = '\0';
+    group->count = morse_code_compile(
+        group->text, MORSE_CODE_TRAINING_GROUP_LEN, group->elements, MORSE_CODE_TRAINING_ELEMENTS_MAX);
+}
+
+static void morse_code_training_defaults(MorseCodeTrainingStats* stats) {
+    memset(stats, 0, sizeof(MorseCodeTrainingStats));
+    stats->level = MORSE_CODE_TRAINING_LEVEL_MIN;
+    stats->gap_delta = MORSE_CODE_TRAINING_GAP_DEFAULT;
+}
+
+static void morse_code_training_record(
+    MorseCodeTrainingCharStats* st, bool correct, bool copied, uint32_t latency) {
+    if(st->attempts >= MORSE_CODE_TRAINING_DECAY_AT) {
+        st->attempts /= 2;
+        st->correct /= 2;
+    }
+    st->attempts++;
+    if(correct) st->correct++;
+    if(copied) {
+        if(latency > UINT16_MAX) latency = UINT16_MAX;
+        st->latency_ms = st->latency_ms ? (uint16_t)((st->latency_ms * 3u + latency) / 4u)
+                                        : (uint16_t)latency;
+    }
+}
+
+static bool morse_code_training_level_up(MorseCodeTraining* training) {
+    MorseCodeTrainingStats* stats = &training->stats;
+    if(stats->level >= MORSE_CODE_TRAINING_CHARS) return false;
+    for(uint8_t i = 0; i < stats->level; i++) {
+        const MorseCodeTrainingCharStats* st = &stats->chars[i];
+        if(st->attempts < MORSE_CODE_TRAINING_LEVEL_ATTEMPTS) return false;
+        if(st->correct * 100u < st->attempts * (uint32_t)MORSE_CODE_TRAINING_LEVEL_PERCENT)
+            return false;
+    }
+    stats->level++;
+    return true;
+}
+
+/* ---------- public API ---------- */
+
+MorseCodeTraining* morse_code_training_alloc(void) {
+    MorseCodeTraining* training = malloc(sizeof(MorseCodeTraining));
+    if(!saved_struct_load(
+           MORSE_CODE_TRAINING_PATH,
+           &training->stats,
+           sizeof(MorseCodeTrainingStats),
+           MORSE_CODE_TRAINING_MAGIC,
+           MORSE_CODE_TRAINING_VERSION)) {
+        FURI_LOG_I(TAG, "No stats, starting at level %d", MORSE_CODE_TRAINING_LEVEL_MIN);
+        morse_code_training_defaults(&training->stats);
+    }
+    if(training->stats.level < MORSE_CODE_TRAINING_LEVEL_MIN ||
+       training->stats.level > MORSE_CODE_TRAINING_CHARS)
+        training->stats.level = MORSE_CODE_TRAINING_LEVEL_MIN;
+    if(training->stats.gap_delta > MORSE_CODE_TRAINING_GAP_MAX)
+        training->stats.gap_delta = MORSE_CODE_TRAINING_GAP_DEFAULT;
+    training->dirty = false;
+
+    training->rng = furi_hal_random_get();
+    if(!training->rng) training->rng = 0x2545F491; /* xorshift must not start at 0 */
+
+    training->current = 0;
+    training->groups[0].text[0] = '\0';
+    training->groups[0].count = 0;
+    training->groups[1].text[0] = '\0';
+    training->groups[1].count = 0;
+    training->copied_len = 0;
+    training->copied[0] = '\0';
+    return training;
+}
+
+void morse_code_training_save(MorseCodeTraining* training) {
+    furi_assert(training);
+    if(!training->dirty) return;
+    if(saved_struct_save(
+           MORSE_CODE_TRAINING_PATH,
+           &training->stats,
+           sizeof(MorseCodeTrainingStats),
+           MORSE_CODE_TRAINING_MAGIC,
+           MORSE_CODE_TRAINING_VERSION)) {
+        training->dirty = false;
+    } else {
+        FURI_LOG_E(TAG, "Cannot save %s", MORSE_CODE_TRAINING_PATH);
+    }
+}
+
+void morse_code_training_free(MorseCodeTraining* training) {
+    furi_assert(training);
+    morse_code_training_save(training);
+    free(training);
+}
+
+void morse_code_training_start(MorseCodeTraining* training) {
+    furi_assert(training);
+    training->current = 0;
+    morse_code_training_generate(training, &training->groups[0]);
+    training->groups[1].count = 0;
+    training->copied_len = 0;
+    training->copied[0] = '\0';
+}
+
+const uint8_t* morse_code_training_program(MorseCodeTraining* training, size_t* count) {
+    furi_assert(training);
+    furi_assert(count);
+    const MorseCodeTrainingGroup* group = &training->groups[training->current];
+    *count = group->count;
+    return group->elements;
+}
+
+bool morse_code_training_feed(MorseCodeTraining* training, char c, uint32_t tick) {
+    furi_assert(training);
+    if(c != ' ' && training->copied_len < MORSE_CODE_TRAINING_GROUP_LEN) {
+        training->copied_tick[training->copied_len] = tick;
+        training->copied[training->copied_len++] = c;
+        training->copied[training->copied_len] = '\0';
+    }
+    return training->copied_len >= MORSE_CODE_TRAINING_GROUP_LEN;
+}
+
+void morse_code_training_score(
+    MorseCodeTraining* training, uint32_t group_end_tick, MorseCodeTrainingResult* result) {
+    furi_assert(training);
+    furi_assert(result);
+    const char* sent = training->groups[training->current].text;
+
+    result->correct = 0;
+    result->total = MORSE_CODE_TRAINING_GROUP_LEN;
+    uint32_t latency_sum = 0;
+
+    /* latency of each character counts from whichever came last:
+     * the end of the group or the previous copied character */
+    uint32_t prev_tick = group_end_tick;
+    for(uint8_t i = 0; i < MORSE_CODE_TRAINING_GROUP_LEN; i++) {
+        const bool copied = i < training->copied_len;
+        const bool correct = copied && training->copied[i] == sent[i];
+        uint32_t latency = 0;
+        if(copied) {
+            const uint32_t tick = training->copied_tick[i];
+            latency = (tick > prev_tick) ? tick - prev_tick : 0;
+            if(tick > prev_tick) prev_tick = tick;
+            latency_sum += latency;
+        }
+        if(correct) result->correct++;
+
+        const int idx = morse_code_training_index(sent[i]);
+        if(idx >= 0) morse_code_training_record(&training->stats.chars[idx], correct, copied, latency);
+    }
+    training->dirty = true;
+
+    result->latency_ms = training->copied_len ? latency_sum / training->copied_len : 0;
+    strlcpy(result->sent, sent, sizeof(result->sent));
+    strlcpy(result->copied, training->copied, sizeof(result->copied));
+    result->leveled_up = morse_code_training_level_up(training);
+}
+
+void morse_code_training_prepare_next(MorseCodeTraining* training) {
+    furi_assert(training);
+    /* the worker copied the current program at playback start, so the
+     * spare slot is free to fill while it plays */
+    morse_code_training_generate(training, &training->groups[training->current ^ 1]);
+}
+
+void morse_code_training_advance(MorseCodeTraining* training) {
+    furi_assert(training);
+    /* the next group was compiled while this one played: just swap it in */
+    training->current ^= 1;
+    if(!training->groups[training->current].count)
+        morse_code_training_generate(training, &training->groups[training->current]);
+    training->copied_len = 0;
+    training->copied[0] = '\0';
+}
+
+uint8_t morse_code_training_level(MorseCodeTraining* training) {
+    furi_assert(training);
+    return training->stats.level;
+}
+
+uint32_t morse_code_training_get_gap(MorseCodeTraining* training) {
+    furi_assert(training);
+    return training->stats.gap_delta;
+}
+
+void morse_code_training_set_gap(MorseCodeTraining* training, uint32_t gap_delta) {
+    furi_assert(training);
+    if(gap_delta > MORSE_CODE_TRAINING_GAP_MAX) gap_delta = MORSE_CODE_TRAINING_GAP_MAX;
+    if(training->stats.gap_delta == gap_delta) return;
+    training->stats.gap_delta = (uint16_t)gap_delta;
+    training->dirty = true;
+}
+#endif
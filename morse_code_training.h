@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "morse_code_worker.h"
+
+#if MORSE_CODE_FEATURE_TRAINING
+
+/* Koch / Farnsworth copy training */
+#define MORSE_CODE_TRAINING_CHARS 36     /* Koch order over A-Z, 0-9 */
+#define MORSE_CODE_TRAINING_GROUP_LEN 5
+#define MORSE_CODE_TRAINING_LEVEL_MIN 2  /* Koch starts with two characters */
+#define MORSE_CODE_TRAINING_GAP_DEFAULT 300 /* ms Farnsworth unit */
+#define MORSE_CODE_TRAINING_GAP_MAX 1000    /* ms: a 7 s word gap */
+/* a group's compiled elements: every character with its letter gap */
+#define MORSE_CODE_TRAINING_ELEMENTS_MAX \
+    (MORSE_CODE_TRAINING_GROUP_LEN * MORSE_CODE_CHAR_ELEMENTS_MAX)
+
+typedef struct {
+    uint8_t correct;
+    uint8_t total;
+    uint32_t latency_ms;  /* mean per-character copy latency */
+    char sent[MORSE_CODE_TRAINING_GROUP_LEN + 1];
+    char copied[MORSE_CODE_TRAINING_GROUP_LEN + 1];
+    bool leveled_up;
+} MorseCodeTrainingResult;
+
+typedef struct MorseCodeTraining MorseCodeTraining;
+
+/* alloc loads the per-character stats; free saves them */
+MorseCodeTraining* morse_code_training_alloc(void);
+void morse_code_training_free(MorseCodeTraining* training);
+void morse_code_training_save(MorseCodeTraining* training);
+
+/* prepares the first group; once its playback has started, call
+ * prepare_next so the following group is compiled while this one plays */
+void morse_code_training_start(MorseCodeTraining* training);
+void morse_code_training_prepare_next(MorseCodeTraining* training);
+/* compiled elements of the current group, `count` of them */
+const uint8_t* morse_code_training_program(MorseCodeTraining* training, size_t* count);
+
+/* copy-back: feed decoded characters; true once the group is fully copied */
+bool morse_code_training_feed(MorseCodeTraining* training, char c, uint32_t tick);
+
+/* score the current group (latency counted from group_end_tick), then
+ * promote the pre-compiled next group */
+void morse_code_training_score(
+    MorseCodeTraining* training, uint32_t group_end_tick, MorseCodeTrainingResult* result);
+void morse_code_training_advance(MorseCodeTraining* training);
+
+uint8_t morse_code_training_level(MorseCodeTraining* training);
+uint32_t morse_code_training_get_gap(MorseCodeTraining* training);
+void morse_code_training_set_gap(MorseCodeTraining* training, uint32_t gap_delta);
+#endif
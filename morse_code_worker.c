@@ -1,78 +1,142 @@
 #include "morse_code_worker.h"
 #include <furi_hal.h>
-#include <lib/flipper_format/flipper_format.h>
+#include <string.h>
+#include <stdatomic.h>
+#if MORSE_CODE_FEATURE_LED
 #include <notification/notification.h>
 #include <notification/notification_messages.h>
-#include <string.h>
+#endif
 
 /* forward declare the worker thread fn */
 static int32_t morse_code_worker_thread_callback(void* context);
+#if MORSE_CODE_FEATURE_PLAYBACK
 /* forward declare the async playback thread fn */
 static int32_t morse_code_worker_playback_thread(void* context);
+#endif
 
 #define TAG "MorseCodeWorker"
-#define MORSE_CODE_VERSION 0
-
-/* Morse tables (A–Z, 1–0) */
-static const char morse_array[36][6] = {
-    ".-","-...","-.-.","-..",".","..-.",
-    "--.","....","..",".---","-.-",".-..",
-    "--","-.","---",".--.","--.-",".-.",
-    "...","-","..-","...-",".--","-..-",
-    "-.--","--..",".----","..---","...--","....-",
-    ".....","-....","--...","---..","----.","-----"
-};
-static const char symbol_array[36] = {
-    'A','B','C','D','E','F','G','H','I','J','K','L',
-    'M','N','O','P','Q','R','S','T','U','V','W','X',
-    'Y','Z','1','2','3','4','5','6','7','8','9','0'
-};
+
+/* longest the keying thread waits for playback to hand over the speaker */
+#define MORSE_CODE_SPEAKER_WAIT_MS 20
+
+#if MORSE_CODE_FEATURE_PLAYBACK
+typedef enum {
+    MorseCodeWorkerEventWake = (1 << 0), /* cancel or break-in: playback re-checks now */
+} MorseCodeWorkerEvent;
+#endif
 
 struct MorseCodeWorker {
     /* live keying thread */
     FuriThread* thread;
     MorseCodeWorkerCallback callback;
     void* callback_context;
+    bool is_started;    /* armed by start(); thread itself spins up lazily */
     bool is_running;
-    bool play;          /* live keying flag */
-    float volume;
-    uint32_t dit_delta;
-    FuriString* buffer;
+    atomic_bool play;   /* live keying flag */
+    MorseCodeDecoder decoder; /* elements of the letter being keyed */
     FuriString* words;
 
-    /* LED / notifications */
-    NotificationApp* notification;
+    /* session log (optional) */
+    MorseCodeLog* log;
+
+    /* run-time counters (optional) */
+    MorseCodeProfile* profile;
 
+    /* published params: seqlock, single writer (UI), lock-free readers.
+     * seq is odd while a write is in progress; version = seq / 2 */
+    atomic_uint params_seq;
+    _Atomic float volume;
+    _Atomic uint32_t dit_delta;
+    _Atomic uint32_t gap_delta;
+    MorseCodeWorkerParams params_shadow; /* writer's copy */
+
+#if MORSE_CODE_FEATURE_PLAYBACK
     /* async playback thread */
     FuriThread* pb_thread;
-    FuriMutex* pb_mutex;
-    FuriString* pb_text;
+    MorseCodeProgram* pb_program;
     bool pb_flash_led;
-    volatile bool pb_cancel;
-    volatile bool pb_running;
+    atomic_bool pb_cancel;
+    atomic_bool pb_running;
+    _Atomic uint32_t pb_end_tick;
+    FuriEventFlag* pb_event; /* wakes the playback thread out of its sleeps */
+    uint32_t pb_span; /* playback thread only: start of the running profile section */
+#endif
+#if MORSE_CODE_FEATURE_LED
+    /* LED / notifications (opened on first playback) */
+    NotificationApp* notification;
+#endif
+#if MORSE_CODE_FEATURE_QSK
+    /* break-in (QSK): key presses during playback preempt it */
+    atomic_uint qsk;             /* MorseCodeQsk */
+    atomic_bool break_pending;   /* a press is waiting for playback to yield */
+    _Atomic uint32_t break_stamp; /* cycle stamp of that press */
+#endif
+
+    /* key history: bit-packed ring, LSB = oldest bit of each byte.
+     * Written by the keying thread only; readers may see a torn oldest
+     * byte, which only affects one column of the drawn strip. */
+    uint8_t timeline[MORSE_CODE_TIMELINE_SAMPLES / 8];
+    atomic_uint timeline_head; /* samples written so far */
 };
 
-/* ---------- live keying decode path ---------- */
+/* ---------- published params ---------- */
+
+static void morse_code_worker_params_publish(MorseCodeWorker* instance) {
+    const MorseCodeWorkerParams* p = &instance->params_shadow;
+    const unsigned seq = atomic_load_explicit(&instance->params_seq, memory_order_relaxed);
+    atomic_store_explicit(&instance->params_seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&instance->volume, p->volume, memory_order_relaxed);
+    atomic_store_explicit(&instance->dit_delta, p->dit_delta, memory_order_relaxed);
+    atomic_store_explicit(&instance->gap_delta, p->gap_delta, memory_order_relaxed);
+    atomic_store_explicit(&instance->params_seq, seq + 2, memory_order_release);
+}
+
+static uint32_t
+    morse_code_worker_params_read(MorseCodeWorker* instance, MorseCodeWorkerParams* params) {
+    unsigned seq0, seq1;
+    for(;;) {
+        seq0 = atomic_load_explicit(&instance->params_seq, memory_order_acquire);
+        params->volume = atomic_load_explicit(&instance->volume, memory_order_relaxed);
+        params->dit_delta = atomic_load_explicit(&instance->dit_delta, memory_order_relaxed);
+        params->gap_delta = atomic_load_explicit(&instance->gap_delta, memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+        seq1 = atomic_load_explicit(&instance->params_seq, memory_order_relaxed);
+        if(!(seq0 & 1) && seq0 == seq1) break;
+        /* writer was preempted mid-update: let it finish instead of spinning */
+        furi_thread_yield();
+    }
+    return seq0 / 2;
+}
 
-static void morse_code_worker_fill_buffer(MorseCodeWorker* instance, uint32_t duration) {
-    if(duration <= instance->dit_delta)
-        furi_string_push_back(instance->buffer, *DOT);
-    else if(duration <= (instance->dit_delta * 3))
-        furi_string_push_back(instance->buffer, *LINE);
+/* ---------- key history ---------- */
+
+static void morse_code_worker_timeline_push(MorseCodeWorker* instance, bool down) {
+    const unsigned head = atomic_load_explicit(&instance->timeline_head, memory_order_relaxed);
+    const unsigned pos = head % MORSE_CODE_TIMELINE_SAMPLES;
+    const uint8_t mask = (uint8_t)(1u << (pos & 7));
+    if(down)
+        instance->timeline[pos >> 3] |= mask;
     else
-        furi_string_reset(instance->buffer);
-    if(furi_string_size(instance->buffer) > 5) furi_string_reset(instance->buffer);
+        instance->timeline[pos >> 3] &= (uint8_t)~mask;
+    atomic_store_explicit(&instance->timeline_head, head + 1, memory_order_release);
+}
+
+/* ---------- live keying decode path ---------- */
+
+static void morse_code_worker_fill_buffer(
+    MorseCodeWorker* instance, uint32_t duration, uint32_t dit_delta) {
+    if(instance->log) morse_code_log_edge(instance->log, true, duration);
+    morse_code_decoder_mark(&instance->decoder, duration, dit_delta);
 }
 
 static void morse_code_worker_fill_letter(MorseCodeWorker* instance) {
     if(furi_string_size(instance->words) > 63) furi_string_reset(instance->words);
-    for(size_t i = 0; i < 36; i++) {
-        if(furi_string_cmp_str(instance->buffer, morse_array[i]) == 0) {
-            furi_string_push_back(instance->words, symbol_array[i]);
-            break;
-        }
+    const char c = morse_code_decoder_letter(&instance->decoder);
+    if(c) {
+        furi_string_push_back(instance->words, c);
+        if(instance->log) morse_code_log_char(instance->log, c);
     }
-    furi_string_reset(instance->buffer);
 }
 
 static int32_t morse_code_worker_thread_callback(void* context) {
@@ -83,36 +147,48 @@ static int32_t morse_code_worker_thread_callback(void* context) {
     uint32_t end_tick = 0;
     bool pushed = true;
     bool spaced = true;
+    MorseCodeWorkerParams params;
+    uint32_t sample_ticks = 0;
+    bool sample_down = false;
+    bool tone_on = false;
 
     while(instance->is_running) {
         furi_delay_ms(SLEEP);
+        const uint32_t span = morse_code_profile_begin();
+        morse_code_worker_params_read(instance, &params);
 
-        if(instance->play) {
+        if(atomic_load_explicit(&instance->play, memory_order_acquire)) {
             if(!was_playing) {
                 start_tick = furi_get_tick();
-                if(furi_hal_speaker_acquire(1000)) {
-                    furi_hal_speaker_start(FREQUENCY, instance->volume);
-                }
+                if(instance->log && end_tick)
+                    morse_code_log_edge(instance->log, false, start_tick - end_tick);
                 was_playing = true;
             }
+            /* on break-in, playback lets go of the speaker within a few ms:
+             * wait briefly, and keep retrying while the key stays down */
+            if(!tone_on && furi_hal_speaker_acquire(MORSE_CODE_SPEAKER_WAIT_MS)) {
+                furi_hal_speaker_start(FREQUENCY, params.volume);
+                tone_on = true;
+            }
         } else {
             if(was_playing) {
                 pushed = false;
                 spaced = false;
-                if(furi_hal_speaker_is_mine()) {
+                if(tone_on) {
                     furi_hal_speaker_stop();
                     furi_hal_speaker_release();
+                    tone_on = false;
                 }
                 end_tick = furi_get_tick();
                 was_playing = false;
-                morse_code_worker_fill_buffer(instance, end_tick - start_tick);
+                morse_code_worker_fill_buffer(instance, end_tick - start_tick, params.dit_delta);
                 start_tick = 0;
             }
         }
 
         if(!pushed) {
-            if(end_tick + (instance->dit_delta * 3) < furi_get_tick()) {
-                if(!furi_string_empty(instance->buffer)) {
+            if(end_tick + params.dit_delta * MORSE_CODE_LETTER_GAP_UNITS < furi_get_tick()) {
+                if(morse_code_decoder_pending(&instance->decoder)) {
                     morse_code_worker_fill_letter(instance);
                     if(instance->callback)
                         instance->callback(instance->words, instance->callback_context);
@@ -123,148 +199,223 @@ static int32_t morse_code_worker_thread_callback(void* context) {
             }
         }
         if(!spaced) {
-            if(end_tick + (instance->dit_delta * 7) < furi_get_tick()) {
+            if(end_tick + params.dit_delta * MORSE_CODE_WORD_GAP_UNITS < furi_get_tick()) {
                 furi_string_push_back(instance->words, *SPACE);
+                if(instance->log) morse_code_log_char(instance->log, *SPACE);
                 if(instance->callback)
                     instance->callback(instance->words, instance->callback_context);
                 spaced = true;
             }
         }
+
+        /* a sample is "down" if the key was down at any point in its window */
+        sample_down |= was_playing;
+        if(++sample_ticks >= MORSE_CODE_TIMELINE_TICKS) {
+            morse_code_worker_timeline_push(instance, sample_down);
+            sample_ticks = 0;
+            sample_down = false;
+        }
+        if(instance->profile) morse_code_profile_end(instance->profile, MorseCodeProfileDecode, span);
     }
+    if(tone_on) {
+        furi_hal_speaker_stop();
+        furi_hal_speaker_release();
+    }
+    if(instance->profile) morse_code_profile_sample_stack(instance->profile, MorseCodeProfileDecode);
     return 0;
 }
 
+#if MORSE_CODE_FEATURE_PLAYBACK
 /* ---------- LED helpers ---------- */
-static inline void led_blue_on(NotificationApp* n) {
-    if(n) notification_message_block(n, &sequence_set_blue_255);
+static inline void led_blue_on(MorseCodeWorker* instance) {
+#if MORSE_CODE_FEATURE_LED
+    if(instance->notification) notification_message_block(instance->notification, &sequence_set_blue_255);
+#else
+    UNUSED(instance);
+#endif
 }
-static inline void led_blue_off(NotificationApp* n) {
-    if(n) notification_message_block(n, &sequence_reset_blue);
+static inline void led_blue_off(MorseCodeWorker* instance) {
+#if MORSE_CODE_FEATURE_LED
+    if(instance->notification) notification_message_block(instance->notification, &sequence_reset_blue);
+#else
+    UNUSED(instance);
+#endif
 }
-static inline void flash_red_once(NotificationApp* n) {
+static inline void flash_red_once(MorseCodeWorker* instance) {
+#if MORSE_CODE_FEATURE_LED
+    NotificationApp* n = instance->notification;
     if(!n) return;
     notification_message_block(n, &sequence_set_red_255);
     furi_delay_ms(120);
     notification_message_block(n, &sequence_reset_red);
+#else
+    UNUSED(instance);
+#endif
 }
 
-/* ---------- playback primitive (blocking, internal) ---------- */
-// static void play_tone_blocking(float freq, float vol, uint32_t ms, NotificationApp* n, bool flash_led) {
-//     if(furi_hal_speaker_acquire(1000)) {
-//         if(flash_led) led_blue_on(n);
-//         furi_hal_speaker_start(freq, vol);
-//         furi_delay_ms(ms);
-//         furi_hal_speaker_stop();
-//         furi_hal_speaker_release();
-//         if(flash_led) led_blue_off(n);
-//     } else {
-//         furi_delay_ms(ms);
-//     }
-// }
-static void gap_blocking(uint32_t ms) { furi_delay_ms(ms); }
-
 /* ---------- async playback thread ---------- */
+static inline bool pb_cancelled(MorseCodeWorker* instance) {
+    return atomic_load_explicit(&instance->pb_cancel, memory_order_acquire);
+}
+
+/* break-in: the operator is keying while playback runs */
+static inline bool pb_broken_into(MorseCodeWorker* instance) {
+#if MORSE_CODE_FEATURE_QSK
+    return atomic_load_explicit(&instance->qsk, memory_order_relaxed) != MorseCodeQskOff &&
+           atomic_load_explicit(&instance->play, memory_order_acquire);
+#else
+    UNUSED(instance);
+    return false;
+#endif
+}
+
+/* Sleeps up to `ms`; cancel and key presses wake it at once. Playback CPU
+ * is whatever runs between sleeps: close the section, sleep, reopen it */
+static void pb_sleep(MorseCodeWorker* instance, uint32_t ms) {
+    if(instance->profile)
+        morse_code_profile_end(instance->profile, MorseCodeProfilePlayback, instance->pb_span);
+    furi_event_flag_wait(
+        instance->pb_event, MorseCodeWorkerEventWake, FuriFlagWaitAny, furi_ms_to_ticks(ms));
+    instance->pb_span = morse_code_profile_begin();
+}
+
+/* waits out one element; false as soon as it is cancelled or broken into */
+static bool pb_wait(MorseCodeWorker* instance, uint32_t ms) {
+    const uint32_t start = furi_get_tick();
+    for(;;) {
+        if(pb_cancelled(instance) || pb_broken_into(instance)) return false;
+        const uint32_t elapsed = furi_get_tick() - start;
+        if(elapsed >= ms) return true;
+        pb_sleep(instance, ms - elapsed);
+    }
+}
+
+#if MORSE_CODE_FEATURE_QSK
+/* the speaker is free again: that closes the preemption latency */
+static void pb_break_in_done(MorseCodeWorker* instance) {
+    if(instance->profile &&
+       atomic_exchange_explicit(&instance->break_pending, false, memory_order_acquire)) {
+        morse_code_profile_end(
+            instance->profile,
+            MorseCodeProfileBreakIn,
+            atomic_load_explicit(&instance->break_stamp, memory_order_relaxed));
+    }
+}
+#endif
+
+static bool pb_tone(MorseCodeWorker* instance, uint32_t ms, float volume, bool flash) {
+    /* never grab the speaker from under a key that is already down */
+    if(pb_cancelled(instance) || pb_broken_into(instance)) return false;
+    if(!furi_hal_speaker_acquire(1000)) return pb_wait(instance, ms);
+
+    if(flash) led_blue_on(instance);
+    furi_hal_speaker_start(FREQUENCY, volume);
+    const bool completed = pb_wait(instance, ms);
+    /* release first: on break-in the keying thread is waiting for it */
+    furi_hal_speaker_stop();
+    furi_hal_speaker_release();
+#if MORSE_CODE_FEATURE_QSK
+    /* stop the clock before the LED's blocking notification round trip */
+    if(!completed) pb_break_in_done(instance);
+#endif
+    if(flash) led_blue_off(instance);
+    return completed;
+}
+
+#if MORSE_CODE_FEATURE_QSK
+/* Resume policy: stay silent while the operator sends, carry on once the
+ * key has been up for a word gap; false if cancelled meanwhile */
+static bool pb_hold(MorseCodeWorker* instance) {
+    MorseCodeWorkerParams params;
+    bool idle = false;
+    uint32_t idle_since = 0;
+    for(;;) {
+        if(pb_cancelled(instance)) return false;
+        morse_code_worker_params_read(instance, &params);
+        const uint32_t now = furi_get_tick();
+        if(atomic_load_explicit(&instance->play, memory_order_acquire)) {
+            idle = false;
+        } else if(!idle) {
+            idle = true;
+            idle_since = now;
+        } else if(
+            now - idle_since >=
+            morse_code_element_ms(MorseCodeElementGapWord, params.dit_delta, params.gap_delta)) {
+            return true;
+        }
+        pb_sleep(instance, SLEEP);
+    }
+}
+#endif
+
 static int32_t morse_code_worker_playback_thread(void* context) {
     MorseCodeWorker* instance = context;
-    /* copy params under mutex */
-    furi_mutex_acquire(instance->pb_mutex, FuriWaitForever);
+    /* pb_program / pb_flash_led are only refilled after this thread is joined */
+    const MorseCodeProgram* program = instance->pb_program;
     const bool flash = instance->pb_flash_led;
-    FuriString* text = furi_string_alloc_set(instance->pb_text);
-    instance->pb_running = true;
-    instance->pb_cancel = false;
-    furi_mutex_release(instance->pb_mutex);
-
-    const uint32_t dit = instance->dit_delta;
-    const uint32_t dah = 3 * dit;
-    const uint32_t intra = dit;
-    const uint32_t inter_letter = 3 * dit;
-    const uint32_t inter_word = 7 * dit;
-
-    /* Make sure live keying isn't holding the speaker */
-    instance->play = false;
-
-    const char* s = furi_string_get_cstr(text);
-    for(const char* p = s; *p; ++p) {
-        if(instance->pb_cancel) { flash_red_once(instance->notification); break; }
-
-        char c = *p;
-        if(c >= 'a' && c <= 'z') c = (char)(c - 'a' + 'A');
-
-        if(c == ' ') {
-            for(uint32_t t = 0; t < inter_word; t += 5) {
-                if(instance->pb_cancel) { flash_red_once(instance->notification); goto done; }
-                gap_blocking(5);
-            }
-            continue;
-        }
-
-        /* lookup morse */
-        const char* code = NULL;
-        for(size_t i = 0; i < 36; i++) {
-            if(symbol_array[i] == c) { code = morse_array[i]; break; }
+    instance->pb_span = morse_code_profile_begin();
+
+#if MORSE_CODE_FEATURE_LED
+    /* Only this thread uses the LEDs; previous playback threads are joined first */
+    if(!instance->notification) instance->notification = furi_record_open(RECORD_NOTIFICATION);
+#endif
+
+    /* Without break-in, make sure live keying isn't holding the speaker */
+    if(!pb_broken_into(instance)) atomic_store_explicit(&instance->play, false, memory_order_release);
+
+    /* Timing is re-sampled at every element boundary so Dit / volume / spacing
+     * changes made during playback apply from the next element on */
+    MorseCodeWorkerParams params;
+    bool completed = true;
+    size_t i = 0;
+#if MORSE_CODE_FEATURE_QSK
+    size_t resume_at = 0; /* first element of the letter being sent */
+#endif
+    while(i < program->count) {
+        if(pb_cancelled(instance)) {
+            completed = false;
+            break;
         }
-        if(!code) {
-            for(uint32_t t = 0; t < inter_letter; t += 5) {
-                if(instance->pb_cancel) { flash_red_once(instance->notification); goto done; }
-                gap_blocking(5);
+#if MORSE_CODE_FEATURE_QSK
+        if(pb_broken_into(instance)) {
+            /* closed already in pb_tone if the break-in landed during a tone */
+            pb_break_in_done(instance);
+            if(atomic_load_explicit(&instance->qsk, memory_order_relaxed) == MorseCodeQskAbort)
+                break;
+            if(!pb_hold(instance)) {
+                completed = false;
+                break;
             }
+            /* the interrupted letter is sent again from its start */
+            i = resume_at;
             continue;
         }
-
-        /* play each element with cancel checks */
-        for(size_t i = 0; code[i] != '\0'; i++) {
-            uint32_t dur = (code[i] == '.') ? dit : dah;
-
-            /* tone with small slices so cancel is responsive */
-            uint32_t played = 0;
-            if(furi_hal_speaker_acquire(1000)) {
-                if(flash) led_blue_on(instance->notification);
-                furi_hal_speaker_start(FREQUENCY, instance->volume);
-                while(played < dur) {
-                    if(instance->pb_cancel) {
-                        furi_hal_speaker_stop();
-                        furi_hal_speaker_release();
-                        if(flash) led_blue_off(instance->notification);
-                        flash_red_once(instance->notification);
-                        goto done;
-                    }
-                    uint32_t slice = (dur - played) > 5 ? 5 : (dur - played);
-                    furi_delay_ms(slice);
-                    played += slice;
-                }
-                furi_hal_speaker_stop();
-                furi_hal_speaker_release();
-                if(flash) led_blue_off(instance->notification);
-            } else {
-                for(uint32_t t = 0; t < dur; t += 5) {
-                    if(instance->pb_cancel) { flash_red_once(instance->notification); goto done; }
-                    furi_delay_ms(5);
-                }
-            }
-
-            /* intra-element gap if more elements */
-            if(code[i + 1] != '\0') {
-                for(uint32_t t = 0; t < intra; t += 5) {
-                    if(instance->pb_cancel) { flash_red_once(instance->notification); goto done; }
-                    furi_delay_ms(5);
-                }
-            }
-        }
-
-        /* inter-letter gap */
-        for(uint32_t t = 0; t < inter_letter; t += 5) {
-            if(instance->pb_cancel) { flash_red_once(instance->notification); goto done; }
-            furi_delay_ms(5);
-        }
+#endif
+
+        morse_code_worker_params_read(instance, &params);
+        const uint8_t element = program->elements[i];
+#if MORSE_CODE_FEATURE_QSK
+        if(element == MorseCodeElementGapLetter || element == MorseCodeElementGapWord)
+            resume_at = i + 1;
+#endif
+        /* Farnsworth: letter / word gaps may use a longer unit than the elements */
+        const uint32_t ms = morse_code_element_ms(element, params.dit_delta, params.gap_delta);
+        const bool done = morse_code_element_is_tone(element) ?
+                              pb_tone(instance, ms, params.volume, flash) :
+                              pb_wait(instance, ms);
+        if(done) i++;
+    }
+    if(!completed) flash_red_once(instance);
+    if(instance->profile) {
+        morse_code_profile_end(instance->profile, MorseCodeProfilePlayback, instance->pb_span);
+        morse_code_profile_sample_stack(instance->profile, MorseCodeProfilePlayback);
     }
 
-done:
-    furi_mutex_acquire(instance->pb_mutex, FuriWaitForever);
-    instance->pb_running = false;
-    furi_mutex_release(instance->pb_mutex);
-    furi_string_free(text);
+    atomic_store_explicit(&instance->pb_end_tick, furi_get_tick(), memory_order_relaxed);
+    atomic_store_explicit(&instance->pb_running, false, memory_order_release);
     return 0;
 }
+#endif
 
 /* ---------------- public API ---------------- */
 
@@ -272,31 +423,55 @@ MorseCodeWorker* morse_code_worker_alloc(void) {
     MorseCodeWorker* instance = malloc(sizeof(MorseCodeWorker));
     instance->thread = furi_thread_alloc();
     furi_thread_set_name(instance->thread, "MorseCodeWorker");
-    furi_thread_set_stack_size(instance->thread, 1024);
+    furi_thread_set_stack_size(instance->thread, MORSE_CODE_WORKER_STACK);
     furi_thread_set_context(instance->thread, instance);
     furi_thread_set_callback(instance->thread, morse_code_worker_thread_callback);
-    instance->play = false;
-    instance->volume = 1.0f;
-    instance->dit_delta = 150;
-    instance->buffer = furi_string_alloc_set_str("");
+    atomic_init(&instance->play, false);
+    atomic_init(&instance->params_seq, 0u);
+    atomic_init(&instance->volume, 1.0f);
+    atomic_init(&instance->dit_delta, 150u);
+    atomic_init(&instance->gap_delta, 0u);
+    instance->params_shadow.volume = 1.0f;
+    instance->params_shadow.dit_delta = 150;
+    instance->params_shadow.gap_delta = 0;
+    morse_code_decoder_reset(&instance->decoder);
     instance->words = furi_string_alloc_set_str("");
-    instance->notification = furi_record_open(RECORD_NOTIFICATION);
+    instance->log = NULL;
+    instance->profile = NULL;
+    instance->is_started = false;
     instance->is_running = false;
     instance->callback = NULL;
     instance->callback_context = NULL;
 
+#if MORSE_CODE_FEATURE_PLAYBACK
     /* async playback init */
     instance->pb_thread = NULL;
-    instance->pb_mutex = furi_mutex_alloc(FuriMutexTypeNormal);
-    instance->pb_text = furi_string_alloc_set_str("");
+    instance->pb_program = malloc(sizeof(MorseCodeProgram));
+    instance->pb_program->count = 0;
     instance->pb_flash_led = true;
-    instance->pb_cancel = false;
-    instance->pb_running = false;
+    atomic_init(&instance->pb_cancel, false);
+    atomic_init(&instance->pb_running, false);
+    atomic_init(&instance->pb_end_tick, 0u);
+    instance->pb_event = furi_event_flag_alloc();
+    instance->pb_span = 0;
+#endif
+#if MORSE_CODE_FEATURE_LED
+    instance->notification = NULL;
+#endif
+#if MORSE_CODE_FEATURE_QSK
+    atomic_init(&instance->qsk, (unsigned)MorseCodeQskOff);
+    atomic_init(&instance->break_pending, false);
+    atomic_init(&instance->break_stamp, 0u);
+#endif
+
+    memset(instance->timeline, 0, sizeof(instance->timeline));
+    atomic_init(&instance->timeline_head, 0u);
     return instance;
 }
 
 void morse_code_worker_free(MorseCodeWorker* instance) {
     furi_assert(instance);
+#if MORSE_CODE_FEATURE_PLAYBACK
     /* stop async playback thread if running */
     morse_code_worker_cancel_playback(instance);
     if(instance->pb_thread) {
@@ -304,14 +479,15 @@ void morse_code_worker_free(MorseCodeWorker* instance) {
         furi_thread_free(instance->pb_thread);
         instance->pb_thread = NULL;
     }
-    furi_mutex_free(instance->pb_mutex);
-    furi_string_free(instance->pb_text);
-
+    free(instance->pb_program);
+    furi_event_flag_free(instance->pb_event);
+#endif
+#if MORSE_CODE_FEATURE_LED
     if(instance->notification) {
         notification_message_block(instance->notification, &sequence_reset_green);
         furi_record_close(RECORD_NOTIFICATION);
     }
-    furi_string_free(instance->buffer);
+#endif
     furi_string_free(instance->words);
     furi_thread_free(instance->thread);
     free(instance);
@@ -324,24 +500,95 @@ void morse_code_worker_set_callback(
     instance->callback_context = context;
 }
 
+void morse_code_worker_set_log(MorseCodeWorker* instance, MorseCodeLog* log) {
+    furi_assert(instance);
+    instance->log = log;
+}
+
+void morse_code_worker_set_profile(MorseCodeWorker* instance, MorseCodeProfile* profile) {
+    furi_assert(instance);
+    instance->profile = profile;
+    if(profile) {
+        morse_code_profile_set_stack(profile, MorseCodeProfileDecode, MORSE_CODE_WORKER_STACK);
+#if MORSE_CODE_FEATURE_PLAYBACK
+        morse_code_profile_set_stack(profile, MorseCodeProfilePlayback, MORSE_CODE_PLAYBACK_STACK);
+#endif
+    }
+}
+
+static void morse_code_worker_ensure_thread(MorseCodeWorker* instance) {
+    /* keying thread is started on the first key press, not at app launch */
+    if(instance->is_started && !instance->is_running) {
+        instance->is_running = true;
+        furi_thread_start(instance->thread);
+    }
+}
+
 void morse_code_worker_play(MorseCodeWorker* instance, bool play) {
     furi_assert(instance);
-    instance->play = play;
+    if(play) morse_code_worker_ensure_thread(instance);
+#if MORSE_CODE_FEATURE_QSK
+    const bool break_in =
+        play && atomic_load_explicit(&instance->pb_running, memory_order_acquire) &&
+        atomic_load_explicit(&instance->qsk, memory_order_relaxed) != MorseCodeQskOff;
+    if(break_in) {
+        /* stamp before the key goes down, so playback always finds it */
+        atomic_store_explicit(&instance->break_stamp, morse_code_profile_begin(), memory_order_relaxed);
+        atomic_store_explicit(&instance->break_pending, true, memory_order_release);
+    }
+    atomic_store_explicit(&instance->play, play, memory_order_release);
+    if(break_in) furi_event_flag_set(instance->pb_event, MorseCodeWorkerEventWake);
+#else
+    atomic_store_explicit(&instance->play, play, memory_order_release);
+#endif
+}
+
+#if MORSE_CODE_FEATURE_QSK
+void morse_code_worker_set_qsk(MorseCodeWorker* instance, MorseCodeQsk qsk) {
+    furi_assert(instance);
+    furi_assert(qsk < MorseCodeQskCount);
+    atomic_store_explicit(&instance->qsk, (unsigned)qsk, memory_order_relaxed);
 }
+#endif
 
 void morse_code_worker_set_volume(MorseCodeWorker* instance, float level) {
     furi_assert(instance);
-    instance->volume = level;
+    if(instance->params_shadow.volume == level) return;
+    instance->params_shadow.volume = level;
+    morse_code_worker_params_publish(instance);
 }
 
 void morse_code_worker_set_dit_delta(MorseCodeWorker* instance, uint32_t delta) {
     furi_assert(instance);
-    instance->dit_delta = delta;
+    if(instance->params_shadow.dit_delta == delta) return;
+    instance->params_shadow.dit_delta = delta;
+    morse_code_worker_params_publish(instance);
+}
+
+void morse_code_worker_set_gap_delta(MorseCodeWorker* instance, uint32_t delta) {
+    furi_assert(instance);
+    if(instance->params_shadow.gap_delta == delta) return;
+    instance->params_shadow.gap_delta = delta;
+    morse_code_worker_params_publish(instance);
+}
+
+void morse_code_worker_get_status(MorseCodeWorker* instance, MorseCodeWorkerStatus* status) {
+    furi_assert(instance);
+    furi_assert(status);
+    status->params_version = morse_code_worker_params_read(instance, &status->params);
+    status->keying = atomic_load_explicit(&instance->play, memory_order_acquire);
+#if MORSE_CODE_FEATURE_PLAYBACK
+    status->playback_active = atomic_load_explicit(&instance->pb_running, memory_order_acquire);
+    status->playback_end_tick = atomic_load_explicit(&instance->pb_end_tick, memory_order_relaxed);
+#else
+    status->playback_active = false;
+    status->playback_end_tick = 0;
+#endif
 }
 
 void morse_code_worker_reset_text(MorseCodeWorker* instance) {
     furi_assert(instance);
-    furi_string_reset(instance->buffer);
+    morse_code_decoder_reset(&instance->decoder);
     furi_string_reset(instance->words);
     if(instance->callback) instance->callback(instance->words, instance->callback_context);
 }
@@ -353,11 +600,57 @@ void morse_code_worker_set_text_cstr(MorseCodeWorker* instance, const char* s) {
     if(instance->callback) instance->callback(instance->words, instance->callback_context);
 }
 
-/* ----- async playback API ----- */
-void morse_code_worker_playback_async(MorseCodeWorker* instance, const char* s, bool flash_led) {
+bool morse_code_worker_get_timeline(MorseCodeWorker* instance, uint8_t* row, size_t width) {
     furi_assert(instance);
-    if(!s) s = "";
+    furi_assert(row);
+    furi_assert(width % 8 == 0 && width <= MORSE_CODE_TIMELINE_SAMPLES);
+
+    const size_t bytes = MORSE_CODE_TIMELINE_SAMPLES / 8;
+    const unsigned head = atomic_load_explicit(&instance->timeline_head, memory_order_acquire);
+    const unsigned start = (head - width) % MORSE_CODE_TIMELINE_SAMPLES;
+    const size_t byte = start >> 3;
+    const unsigned shift = start & 7;
+
+    /* byte-wise funnel shift: each output byte is stitched from two ring bytes */
+    uint8_t any = 0;
+    for(size_t j = 0; j < width / 8; j++) {
+        const uint8_t lo = instance->timeline[(byte + j) % bytes];
+        const uint8_t hi = instance->timeline[(byte + j + 1) % bytes];
+        row[j] = shift ? (uint8_t)((lo >> shift) | (hi << (8 - shift))) : lo;
+        any |= row[j];
+    }
+    return any != 0;
+}
+
+#if MORSE_CODE_FEATURE_PLAYBACK
+/* ----- compiled playback ----- */
+size_t morse_code_worker_compile(const char* s, MorseCodeProgram* program) {
+    furi_assert(program);
+    program->count = 0;
+    if(s) program->count = morse_code_compile(s, strlen(s), program->elements, MORSE_CODE_PROGRAM_MAX);
+    return program->count;
+}
+
+static void morse_code_worker_playback_start(MorseCodeWorker* instance, bool flash_led) {
+    instance->pb_flash_led = flash_led;
+
+    /* active from now, not from when the thread gets scheduled */
+    atomic_store_explicit(&instance->pb_cancel, false, memory_order_relaxed);
+#if MORSE_CODE_FEATURE_QSK
+    atomic_store_explicit(&instance->break_pending, false, memory_order_relaxed);
+#endif
+    furi_event_flag_clear(instance->pb_event, MorseCodeWorkerEventWake);
+    atomic_store_explicit(&instance->pb_running, true, memory_order_release);
+
+    instance->pb_thread = furi_thread_alloc();
+    furi_thread_set_name(instance->pb_thread, "MorsePB");
+    furi_thread_set_stack_size(instance->pb_thread, MORSE_CODE_PLAYBACK_STACK);
+    furi_thread_set_context(instance->pb_thread, instance);
+    furi_thread_set_callback(instance->pb_thread, morse_code_worker_playback_thread);
+    furi_thread_start(instance->pb_thread);
+}
 
+static void morse_code_worker_playback_join(MorseCodeWorker* instance) {
     /* If a previous playback is running, cancel and join it first */
     if(instance->pb_thread) {
         morse_code_worker_cancel_playback(instance);
@@ -365,49 +658,55 @@ void morse_code_worker_playback_async(MorseCodeWorker* instance, const char* s,
         furi_thread_free(instance->pb_thread);
         instance->pb_thread = NULL;
     }
+}
 
-    furi_mutex_acquire(instance->pb_mutex, FuriWaitForever);
-    furi_string_set_str(instance->pb_text, s);
-    instance->pb_flash_led = flash_led;
-    instance->pb_cancel = false;
-    instance->pb_running = false;
-    furi_mutex_release(instance->pb_mutex);
+/* ----- async playback API ----- */
+void morse_code_worker_playback_async(MorseCodeWorker* instance, const char* s, bool flash_led) {
+    furi_assert(instance);
+    morse_code_worker_playback_join(instance);
+    morse_code_worker_compile(s, instance->pb_program);
+    morse_code_worker_playback_start(instance, flash_led);
+}
 
-    instance->pb_thread = furi_thread_alloc();
-    furi_thread_set_name(instance->pb_thread, "MorsePB");
-    furi_thread_set_stack_size(instance->pb_thread, 1024);
-    furi_thread_set_context(instance->pb_thread, instance);
-    furi_thread_set_callback(instance->pb_thread, morse_code_worker_playback_thread);
-    furi_thread_start(instance->pb_thread);
+void morse_code_worker_playback_program_async(
+    MorseCodeWorker* instance, const uint8_t* elements, size_t count, bool flash_led) {
+    furi_assert(instance);
+    furi_assert(elements || !count);
+    furi_assert(count <= MORSE_CODE_PROGRAM_MAX);
+    morse_code_worker_playback_join(instance);
+    instance->pb_program->count = count;
+    memcpy(instance->pb_program->elements, elements, count);
+    morse_code_worker_playback_start(instance, flash_led);
 }
 
 void morse_code_worker_cancel_playback(MorseCodeWorker* instance) {
     furi_assert(instance);
-    instance->pb_cancel = true;
+    atomic_store_explicit(&instance->pb_cancel, true, memory_order_release);
+    furi_event_flag_set(instance->pb_event, MorseCodeWorkerEventWake);
 }
 
 bool morse_code_worker_is_playback_active(MorseCodeWorker* instance) {
     furi_assert(instance);
-    bool running = false;
-    furi_mutex_acquire(instance->pb_mutex, FuriWaitForever);
-    running = instance->pb_running;
-    furi_mutex_release(instance->pb_mutex);
-    return running;
+    return atomic_load_explicit(&instance->pb_running, memory_order_acquire);
 }
+#endif
 
 /* ----- lifecycle ----- */
 void morse_code_worker_start(MorseCodeWorker* instance) {
-    furi_assert(instance && !instance->is_running);
-    instance->is_running = true;
-    furi_thread_start(instance->thread);
+    furi_assert(instance && !instance->is_started);
+    instance->is_started = true;
 }
 
 void morse_code_worker_stop(MorseCodeWorker* instance) {
-    furi_assert(instance && instance->is_running);
-    instance->play = false;
-    instance->is_running = false;
-    furi_thread_join(instance->thread);
+    furi_assert(instance && instance->is_started);
+    atomic_store_explicit(&instance->play, false, memory_order_release);
+    instance->is_started = false;
+    if(instance->is_running) {
+        instance->is_running = false;
+        furi_thread_join(instance->thread);
+    }
 
+#if MORSE_CODE_FEATURE_PLAYBACK
     /* stop async playback if any */
     morse_code_worker_cancel_playback(instance);
     if(instance->pb_thread) {
@@ -415,8 +714,10 @@ void morse_code_worker_stop(MorseCodeWorker* instance) {
         furi_thread_free(instance->pb_thread);
         instance->pb_thread = NULL;
     }
-
+#endif
+#if MORSE_CODE_FEATURE_LED
     if(instance->notification) {
         notification_message_block(instance->notification, &sequence_reset_green);
     }
+#endif
 }
@@ -3,6 +3,10 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <furi.h>
+#include "morse_code_config.h"
+#include "morse_code_core.h"
+#include "morse_code_log.h"
+#include "morse_code_profile.h"
 
 /* Tone + timing */
 #define FREQUENCY 261.63f
@@ -11,32 +15,112 @@
 #define LINE "-"
 #define SPACE " "
 
+/* thread stacks (bytes), reported against their high-water marks */
+#define MORSE_CODE_WORKER_STACK 1024
+#define MORSE_CODE_PLAYBACK_STACK 1024
+
+/* Key history: one bit per MORSE_CODE_TIMELINE_TICKS keying loops (30 ms),
+ * 128 samples = ~3.8 s */
+#define MORSE_CODE_TIMELINE_SAMPLES 128
+#define MORSE_CODE_TIMELINE_TICKS 3
+
 typedef void (*MorseCodeWorkerCallback)(FuriString* buffer, void* context);
 
 typedef struct MorseCodeWorker MorseCodeWorker;
 
-/* lifecycle */
+#if MORSE_CODE_FEATURE_PLAYBACK
+/* Compiled playback: text is expanded once into timing elements
+ * (MorseCodeElement), so the playback thread only walks an array (and
+ * callers can compile ahead, into buffers sized for what they send) */
+#define MORSE_CODE_PROGRAM_MAX 1280 /* 128 chars x worst case 10 elements */
+
+typedef struct {
+    uint8_t elements[MORSE_CODE_PROGRAM_MAX]; /* MorseCodeElement */
+    size_t count;
+} MorseCodeProgram;
+#endif
+
+/* Break-in (QSK): what keying during playback does (kept in every build,
+ * settings.bin has the same layout whatever is compiled in) */
+typedef enum {
+    MorseCodeQskOff,    /* playback owns the speaker, the key is ignored */
+    MorseCodeQskResume, /* playback pauses, then resends the interrupted letter after a word gap */
+    MorseCodeQskAbort,  /* playback ends */
+    MorseCodeQskCount,
+} MorseCodeQsk;
+
+/* parameters as published to the keying / playback threads */
+typedef struct {
+    float volume;
+    uint32_t dit_delta;
+    uint32_t gap_delta; /* Farnsworth letter/word gap unit; <= dit_delta means none */
+} MorseCodeWorkerParams;
+
+/* consistent snapshot, readable from any thread without taking a lock */
+typedef struct {
+    MorseCodeWorkerParams params;
+    uint32_t params_version; /* bumps on every published param change */
+    bool keying;             /* live key is down */
+    bool playback_active;
+    uint32_t playback_end_tick; /* when the last playback finished or was cancelled */
+} MorseCodeWorkerStatus;
+
+/* lifecycle (start arms the worker; threads and records are set up on first use) */
 MorseCodeWorker* morse_code_worker_alloc(void);
 void morse_code_worker_free(MorseCodeWorker* instance);
 void morse_code_worker_start(MorseCodeWorker* instance);
 void morse_code_worker_stop(MorseCodeWorker* instance);
 
-/* live keying (press/hold) */
+/* live keying (press/hold); with break-in enabled this also preempts playback */
 void morse_code_worker_play(MorseCodeWorker* instance, bool play);
+#if MORSE_CODE_FEATURE_QSK
+void morse_code_worker_set_qsk(MorseCodeWorker* instance, MorseCodeQsk qsk);
+#endif
 
 /* decoded text buffer mgmt */
 void morse_code_worker_reset_text(MorseCodeWorker* instance);
 void morse_code_worker_set_text_cstr(MorseCodeWorker* instance, const char* s);
 
-/* params */
+/* params (single writer; playback picks changes up at the next element) */
 void morse_code_worker_set_volume(MorseCodeWorker* instance, float level);
 void morse_code_worker_set_dit_delta(MorseCodeWorker* instance, uint32_t delta);
+void morse_code_worker_set_gap_delta(MorseCodeWorker* instance, uint32_t delta);
+
+/* lock-free status query */
+void morse_code_worker_get_status(MorseCodeWorker* instance, MorseCodeWorkerStatus* status);
+
+/* newest `width` key samples (multiple of 8) as one XBM row, oldest on the
+ * left; returns true if any of them is key-down */
+bool morse_code_worker_get_timeline(MorseCodeWorker* instance, uint8_t* row, size_t width);
+
+/* session log sink (optional, not owned) */
+void morse_code_worker_set_log(MorseCodeWorker* instance, MorseCodeLog* log);
+
+/* run-time counters for the keying / playback threads (optional, not owned) */
+void morse_code_worker_set_profile(MorseCodeWorker* instance, MorseCodeProfile* profile);
 
 /* callbacks */
 void morse_code_worker_set_callback(
     MorseCodeWorker* instance, MorseCodeWorkerCallback callback, void* context);
 
+#if MORSE_CODE_FEATURE_PLAYBACK
+/* text -> elements; stops at the last letter that fits, returns element count */
+size_t morse_code_worker_compile(const char* s, MorseCodeProgram* program);
+
 /* async playback (non-blocking) + cancel */
 void morse_code_worker_playback_async(MorseCodeWorker* instance, const char* s, bool flash_led);
+/* precompiled elements (up to MORSE_CODE_PROGRAM_MAX), copied before it returns */
+void morse_code_worker_playback_program_async(
+    MorseCodeWorker* instance, const uint8_t* elements, size_t count, bool flash_led);
 void morse_code_worker_cancel_playback(MorseCodeWorker* instance);
 bool morse_code_worker_is_playback_active(MorseCodeWorker* instance);
+#else
+/* playback compiled out: nothing ever plays */
+static inline void morse_code_worker_cancel_playback(MorseCodeWorker* instance) {
+    UNUSED(instance);
+}
+static inline bool morse_code_worker_is_playback_active(MorseCodeWorker* instance) {
+    UNUSED(instance);
+    return false;
+}
+#endif
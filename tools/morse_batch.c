@@ -0,0 +1,481 @@
+/* morse_batch: transcode many files at once on top of the shared Morse core.
+ *
+ *   morse_batch [options] file...
+ *     -f edges|elements|wav  encode text to this output (default edges)
+ *     -d                     decode edge traces (session logs) to text
+ *     -s dit_ms              Dit length (default 150, the app's default)
+ *     -g gap_ms              Farnsworth letter/word gap unit (default none)
+ *     -G letter,word         decode gap thresholds in units (default 3,7, the
+ *                            keying thread's; 2,5 for nominal timing)
+ *     -r rate -F hz          WAV sample rate / tone (default 8000 / 700)
+ *     -o dir                 output directory (default: next to the input)
+ *     -j threads -P          worker count (default: all cores) / pin to cores
+ *     -V                     verify against the reference path (slow); encoding
+ *                            is also decoded back and compared with the text
+ *
+ * Files are queued largest-first across per-worker deques; idle workers
+ * steal. Each file streams through fixed-size buffers, so memory does not
+ * grow with input size. */
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "pool.h"
+#include "transcode.h"
+
+#define BATCH_BLOCK (64 * 1024)
+#define BATCH_LINE_MAX 256
+
+typedef enum {
+    BatchFormatEdges,
+    BatchFormatElements,
+    BatchFormatWav,
+    BatchFormatText, /* decode */
+} BatchFormat;
+
+static const char* const batch_ext[] = {".edges", ".elements", ".wav", ".txt"};
+
+typedef struct {
+    BatchFormat format;
+    TranscodeTiming timing;
+    TranscodeGaps gaps; /* -d */
+    uint32_t sample_rate;
+    float freq;
+    bool verify;
+} BatchConfig;
+
+typedef struct {
+    const char* in;
+    char* out;
+    size_t size;
+    bool ok;
+} BatchJob;
+
+typedef struct {
+    uint64_t bytes_in;
+    uint64_t bytes_out;
+    uint64_t mismatches;
+} BatchCounters;
+
+typedef struct {
+    const BatchConfig* config;
+    BatchCounters* counters; /* one per worker, no sharing */
+} BatchContext;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+typedef struct {
+    char* data;
+    size_t len;
+    size_t cap;
+} BatchText;
+
+static void batch_text_append(BatchText* text, const char* s, size_t n) {
+    if(text->len + n > text->cap) {
+        text->cap = (text->cap + n) * 2;
+        text->data = realloc(text->data, text->cap);
+    }
+    memcpy(text->data + text->len, s, n);
+    text->len += n;
+}
+
+/* ---------- encode ---------- */
+
+/* -V round trip: what decoding the encoded text must give back. Known
+ * characters come back upper-case; any run of other characters after a
+ * letter is at least a letter gap plus another 3 or 7 units, so it reads
+ * as one word space; nothing before the first letter is heard at all */
+typedef struct {
+    BatchText text;
+    bool letter; /* a letter has been sent */
+    bool space;  /* other characters followed it */
+} BatchExpect;
+
+static void batch_expect(BatchExpect* expect, const uint8_t* in, size_t len) {
+    for(size_t i = 0; i < len; i++) {
+        char c = (char)in[i];
+        if(!morse_code_encode_char(c)) {
+            expect->space = expect->letter;
+            continue;
+        }
+        if(expect->space) batch_text_append(&expect->text, " ", 1);
+        if(c >= 'a' && c <= 'z') c = (char)(c - 'a' + 'A');
+        batch_text_append(&expect->text, &c, 1);
+        expect->letter = true;
+        expect->space = false;
+    }
+}
+
+/* feeds "E:" records through the trace decoder */
+static void batch_decode_records(
+    TranscodeDecoder* decoder, const char* records, size_t len, BatchText* text) {
+    const char* end = records + len;
+    while(records < end) {
+        const char* eol = memchr(records, '\n', (size_t)(end - records));
+        char chars[2];
+        const size_t n = transcode_decode_line(decoder, records, chars);
+        batch_text_append(text, chars, n);
+        records = eol ? eol + 1 : end;
+    }
+}
+
+static bool batch_encode(
+    const BatchConfig* config, FILE* in, const char* out_path, BatchCounters* counters) {
+    uint8_t* text = malloc(BATCH_BLOCK);
+    uint8_t* elements = malloc(TRANSCODE_ENCODE_BOUND(BATCH_BLOCK));
+    uint8_t* reference = config->verify ? malloc(TRANSCODE_ENCODE_BOUND(BATCH_BLOCK)) : NULL;
+    char* records = NULL;
+
+    /* -V also decodes every block back, whatever the output format */
+    char* check = config->verify ?
+                      malloc(TRANSCODE_ENCODE_BOUND(BATCH_BLOCK) * TRANSCODE_EDGE_MAX) :
+                      NULL;
+    TranscodeEdges check_edges = {0};
+    TranscodeDecoder check_decoder;
+    transcode_decoder_init(&check_decoder, &config->timing, TRANSCODE_GAPS_NOMINAL);
+    BatchExpect expect = {0};
+    BatchText decoded = {0};
+
+    FILE* out = NULL;
+    WavWriter wav;
+    TranscodeTone tone;
+    TranscodeEdges edges = {0};
+    bool ok;
+    if(config->format == BatchFormatWav) {
+        ok = wav_writer_open(&wav, out_path, config->sample_rate);
+        tone = (TranscodeTone){
+            .writer = &wav,
+            .freq = config->freq,
+            .amplitude = 0.5f,
+            .ramp = config->sample_rate / 200, /* 5 ms, no key clicks */
+        };
+    } else {
+        out = fopen(out_path, "wb");
+        ok = out != NULL;
+        if(!ok) fprintf(stderr, "%s: %s\n", out_path, strerror(errno));
+        if(config->format == BatchFormatEdges)
+            records = malloc(TRANSCODE_ENCODE_BOUND(BATCH_BLOCK) * TRANSCODE_EDGE_MAX);
+    }
+
+    size_t n;
+    while(ok && (n = fread(text, 1, BATCH_BLOCK, in)) > 0) {
+        counters->bytes_in += n;
+        const size_t count = transcode_encode(text, n, elements);
+        if(reference) {
+            const size_t ref = morse_code_compile(
+                (const char*)text, n, reference, TRANSCODE_ENCODE_BOUND(BATCH_BLOCK));
+            if(ref != count || memcmp(reference, elements, count) != 0) counters->mismatches++;
+
+            batch_expect(&expect, text, n);
+            const size_t len = transcode_edges(&check_edges, &config->timing, elements, count, check);
+            batch_decode_records(&check_decoder, check, len, &decoded);
+        }
+
+        switch(config->format) {
+        case BatchFormatElements:
+            ok = fwrite(elements, 1, count, out) == count;
+            counters->bytes_out += count;
+            break;
+        case BatchFormatEdges: {
+            const size_t len = transcode_edges(&edges, &config->timing, elements, count, records);
+            ok = fwrite(records, 1, len, out) == len;
+            counters->bytes_out += len;
+            break;
+        }
+        case BatchFormatWav: {
+            const size_t before = wav.count;
+            ok = transcode_tone(&tone, &config->timing, elements, count);
+            counters->bytes_out += (wav.count - before) * 2u;
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    if(config->format == BatchFormatWav) {
+        if(wav.file && !wav_writer_close(&wav)) ok = false;
+    } else if(out) {
+        if(config->format == BatchFormatEdges && ok) {
+            char tail[TRANSCODE_EDGE_MAX];
+            const size_t len = transcode_edges_flush(&edges, tail);
+            ok = fwrite(tail, 1, len, out) == len;
+            counters->bytes_out += len;
+        }
+        if(fclose(out) != 0) ok = false;
+    }
+
+    if(check && ok) {
+        char tail[TRANSCODE_EDGE_MAX];
+        batch_decode_records(
+            &check_decoder, tail, transcode_edges_flush(&check_edges, tail), &decoded);
+        char chars[2];
+        batch_text_append(&decoded, chars, transcode_decode_end(&check_decoder, chars));
+        if(expect.space) batch_text_append(&expect.text, " ", 1);
+        if(decoded.len != expect.text.len ||
+           memcmp(decoded.data, expect.text.data, decoded.len) != 0)
+            counters->mismatches++;
+    }
+    free(decoded.data);
+    free(expect.text.data);
+    free(check);
+    free(records);
+    free(reference);
+    free(elements);
+    free(text);
+    return ok;
+}
+
+/* ---------- decode ---------- */
+
+static bool batch_decode(
+    const BatchConfig* config, FILE* in, const char* out_path, BatchCounters* counters) {
+    FILE* out = fopen(out_path, "wb");
+    if(!out) {
+        fprintf(stderr, "%s: %s\n", out_path, strerror(errno));
+        return false;
+    }
+    setvbuf(out, NULL, _IOFBF, BATCH_BLOCK);
+
+    TranscodeDecoder decoder;
+    transcode_decoder_init(&decoder, &config->timing, config->gaps);
+
+    /* session logs also carry the characters the device decoded ("C:"):
+     * with -V they are compared against ours */
+    BatchText logged = {0};
+    BatchText decoded = {0};
+
+    bool ok = true;
+    bool end = false;
+    char line[BATCH_LINE_MAX];
+    while(!end) {
+        char chars[2];
+        size_t n;
+        if(fgets(line, sizeof(line), in)) {
+            counters->bytes_in += strlen(line);
+            n = transcode_decode_line(&decoder, line, chars);
+            if(config->verify && line[0] == 'C' && line[1] == ':') {
+                const char* p = strchr(line + 3, ' ');
+                if(p) {
+                    const char c = (char)strtoul(p + 1, NULL, 10);
+                    batch_text_append(&logged, &c, 1);
+                }
+            }
+        } else {
+            /* end of trace: the key stays up, so a pending letter completes */
+            n = transcode_decode_end(&decoder, chars);
+            end = true;
+        }
+        if(!n) continue;
+        if(config->verify) batch_text_append(&decoded, chars, n);
+        if(fwrite(chars, 1, n, out) != n) ok = false;
+        counters->bytes_out += n;
+    }
+
+    /* only traces that carry character records can be checked */
+    if(config->verify && logged.len &&
+       (logged.len != decoded.len || memcmp(logged.data, decoded.data, logged.len) != 0))
+        counters->mismatches++;
+
+    free(decoded.data);
+    free(logged.data);
+    if(fclose(out) != 0) ok = false;
+    return ok;
+}
+
+static void batch_task(void* task, unsigned worker, void* context) {
+    BatchJob* job = task;
+    BatchContext* ctx = context;
+    BatchCounters* counters = &ctx->counters[worker];
+
+    FILE* in = fopen(job->in, "rb");
+    if(!in) {
+        fprintf(stderr, "%s: %s\n", job->in, strerror(errno));
+        job->ok = false;
+        return;
+    }
+    setvbuf(in, NULL, _IOFBF, BATCH_BLOCK);
+    const uint64_t mismatches = counters->mismatches;
+    job->ok = (ctx->config->format == BatchFormatText) ?
+                  batch_decode(ctx->config, in, job->out, counters) :
+                  batch_encode(ctx->config, in, job->out, counters);
+    fclose(in);
+    if(counters->mismatches != mismatches) {
+        fprintf(stderr, "%s: output differs from the reference path\n", job->in);
+    }
+}
+
+/* ---------- main ---------- */
+
+static char* batch_out_path(const char* in, const char* dir, const char* ext) {
+    const char* base = strrchr(in, '/');
+    base = base ? base + 1 : in;
+    const size_t len = (dir ? strlen(dir) + 1 + strlen(base) : strlen(in)) + strlen(ext) + 1;
+    char* out = malloc(len);
+    if(dir)
+        snprintf(out, len, "%s/%s%s", dir, base, ext);
+    else
+        snprintf(out, len, "%s%s", in, ext);
+    return out;
+}
+
+static int batch_job_cmp(const void* a, const void* b) {
+    const BatchJob* x = a;
+    const BatchJob* y = b;
+    return (x->size < y->size) - (x->size > y->size);
+}
+
+static void usage(void) {
+    fprintf(
+        stderr,
+        "usage: morse_batch [-f edges|elements|wav | -d] [-s dit_ms] [-g gap_ms]\n"
+        "                   [-G letter,word] [-r rate] [-F hz] [-o dir] [-j threads] [-P] [-V] file...\n");
+}
+
+int main(int argc, char** argv) {
+    BatchConfig config = {
+        .format = BatchFormatEdges,
+        .timing = {.dit = 150, .gap_delta = 0},
+        .gaps = TRANSCODE_GAPS_KEYER,
+        .sample_rate = 8000,
+        .freq = 700.0f,
+        .verify = false,
+    };
+    const char* dir = NULL;
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    bool pin = false;
+
+    int opt;
+    while((opt = getopt(argc, argv, "f:ds:g:G:r:F:o:j:PV")) != -1) {
+        switch(opt) {
+        case 'f':
+            if(!strcmp(optarg, "edges"))
+                config.format = BatchFormatEdges;
+            else if(!strcmp(optarg, "elements"))
+                config.format = BatchFormatElements;
+            else if(!strcmp(optarg, "wav"))
+                config.format = BatchFormatWav;
+            else {
+                usage();
+                return 2;
+            }
+            break;
+        case 'd':
+            config.format = BatchFormatText;
+            break;
+        case 's':
+            config.timing.dit = (uint32_t)atol(optarg);
+            break;
+        case 'g':
+            config.timing.gap_delta = (uint32_t)atol(optarg);
+            break;
+        case 'G':
+            if(sscanf(optarg, "%u,%u", &config.gaps.letter, &config.gaps.word) != 2 ||
+               config.gaps.letter == 0 || config.gaps.word < config.gaps.letter) {
+                usage();
+                return 2;
+            }
+            break;
+        case 'r':
+            config.sample_rate = (uint32_t)atol(optarg);
+            break;
+        case 'F':
+            config.freq = (float)atof(optarg);
+            break;
+        case 'o':
+            dir = optarg;
+            break;
+        case 'j':
+            threads = atol(optarg);
+            break;
+        case 'P':
+            pin = true;
+            break;
+        case 'V':
+            config.verify = true;
+            break;
+        default:
+            usage();
+            return 2;
+        }
+    }
+    if(optind >= argc || config.timing.dit == 0 || config.sample_rate == 0) {
+        usage();
+        return 2;
+    }
+    if(threads < 1) threads = 1;
+    transcode_init();
+
+    const size_t count = (size_t)(argc - optind);
+    BatchJob* jobs = calloc(count, sizeof(BatchJob));
+    for(size_t i = 0; i < count; i++) {
+        struct stat st;
+        jobs[i].in = argv[optind + (int)i];
+        jobs[i].size = (stat(jobs[i].in, &st) == 0) ? (size_t)st.st_size : 0;
+        jobs[i].out = batch_out_path(jobs[i].in, dir, batch_ext[config.format]);
+    }
+    /* dealt round-robin by size; each owner pops from the back of its deque,
+     * so queue smallest first: owners start on their largest file and
+     * thieves pick up the small ones left at the end */
+    qsort(jobs, count, sizeof(BatchJob), batch_job_cmp);
+
+    Pool* pool = pool_alloc((unsigned)threads, pin);
+    for(size_t i = count; i-- > 0;) pool_push(pool, (unsigned)(i % (size_t)threads), &jobs[i]);
+    BatchCounters* counters = calloc((size_t)threads, sizeof(BatchCounters));
+    BatchContext ctx = {.config = &config, .counters = counters};
+
+    const double t0 = now_seconds();
+    pool_run(pool, batch_task, &ctx);
+    const double wall = now_seconds() - t0;
+
+    uint64_t total_in = 0, total_out = 0, mismatches = 0;
+    fprintf(stderr, "worker  core  files stolen      MB in     MB out   busy s     MB/s\n");
+    for(unsigned w = 0; w < pool_workers(pool); w++) {
+        const PoolWorkerStats* st = pool_stats(pool, w);
+        const double mb = (double)counters[w].bytes_in / 1e6;
+        fprintf(
+            stderr,
+            "%6u %5u %6llu %6llu %10.2f %10.2f %8.3f %8.1f\n",
+            w,
+            st->cpu,
+            (unsigned long long)st->tasks,
+            (unsigned long long)st->stolen,
+            mb,
+            (double)counters[w].bytes_out / 1e6,
+            st->busy_s,
+            st->busy_s > 0.0 ? mb / st->busy_s : 0.0);
+        total_in += counters[w].bytes_in;
+        total_out += counters[w].bytes_out;
+        mismatches += counters[w].mismatches;
+    }
+    fprintf(
+        stderr,
+        "total: %zu files, %.2f MB in, %.2f MB out, %.3f s wall, %.1f MB/s\n",
+        count,
+        (double)total_in / 1e6,
+        (double)total_out / 1e6,
+        wall,
+        wall > 0.0 ? (double)total_in / 1e6 / wall : 0.0);
+
+    int status = 0;
+    for(size_t i = 0; i < count; i++) {
+        if(!jobs[i].ok) status = 1;
+        free(jobs[i].out);
+    }
+    if(config.verify) {
+        fprintf(stderr, "verify: %llu mismatches\n", (unsigned long long)mismatches);
+        if(mismatches) status = 1;
+    }
+
+    free(counters);
+    pool_free(pool);
+    free(jobs);
+    return status;
+}
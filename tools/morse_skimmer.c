@@ -0,0 +1,154 @@
+/* morse_skimmer: decode every CW signal in a recorded band segment.
+ *
+ *   morse_skimmer [-j threads] [-l low_hz] [-h high_hz] [-w window] file.wav
+ *
+ * Bins are split into contiguous ranges, one per thread; throughput is
+ * reported as decoded channels x real-time factor. */
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "skimmer.h"
+#include "wav.h"
+
+typedef struct {
+    MorseSkimmer* skimmer;
+    const float* pcm;
+    size_t count;
+    size_t bin_first;
+    size_t bin_last;
+    double seconds;
+} SkimmerJob;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void* skimmer_job(void* context) {
+    SkimmerJob* job = context;
+    const double t0 = now_seconds();
+    morse_skimmer_process(job->skimmer, job->pcm, job->count, job->bin_first, job->bin_last);
+    job->seconds = now_seconds() - t0;
+    return NULL;
+}
+
+static void usage(void) {
+    fprintf(
+        stderr,
+        "usage: morse_skimmer [-j threads] [-l low_hz] [-h high_hz] [-w window] file.wav\n");
+}
+
+int main(int argc, char** argv) {
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    float f_lo = 300.0f, f_hi = 2700.0f;
+    uint32_t window_ms = 0;
+
+    int opt;
+    while((opt = getopt(argc, argv, "j:l:h:w:")) != -1) {
+        switch(opt) {
+        case 'j':
+            threads = atol(optarg);
+            break;
+        case 'l':
+            f_lo = (float)atof(optarg);
+            break;
+        case 'h':
+            f_hi = (float)atof(optarg);
+            break;
+        case 'w':
+            window_ms = (uint32_t)atol(optarg);
+            break;
+        default:
+            usage();
+            return 2;
+        }
+    }
+    if(optind != argc - 1 || f_hi <= f_lo) {
+        usage();
+        return 2;
+    }
+    if(threads < 1) threads = 1;
+
+    Wav wav;
+    if(!wav_read(argv[optind], &wav)) return 1;
+
+    float* pcm = malloc((wav.count ? wav.count : 1) * sizeof(float));
+    for(size_t i = 0; i < wav.count; i++) pcm[i] = (float)wav.samples[i] * (1.0f / 32768.0f);
+
+    /* default 20 ms window (50 Hz bins) with a 5 ms hop */
+    if(!window_ms) window_ms = 20;
+    MorseSkimmerConfig config = {
+        .sample_rate = wav.sample_rate,
+        .window = wav.sample_rate * window_ms / 1000,
+        .hop = wav.sample_rate / 200,
+        .f_lo = f_lo,
+        .f_hi = f_hi,
+        .bin_spacing = 0.0f,
+    };
+    if(config.hop == 0) config.hop = 1;
+    MorseSkimmer* skimmer = morse_skimmer_alloc(&config);
+    const size_t bins = morse_skimmer_bins(skimmer);
+    if((size_t)threads > bins) threads = (long)bins;
+
+    pthread_t* tids = calloc((size_t)threads, sizeof(pthread_t));
+    SkimmerJob* jobs = calloc((size_t)threads, sizeof(SkimmerJob));
+    const double t0 = now_seconds();
+    for(long t = 0; t < threads; t++) {
+        jobs[t] = (SkimmerJob){
+            .skimmer = skimmer,
+            .pcm = pcm,
+            .count = wav.count,
+            .bin_first = bins * (size_t)t / (size_t)threads,
+            .bin_last = bins * (size_t)(t + 1) / (size_t)threads,
+        };
+        pthread_create(&tids[t], NULL, skimmer_job, &jobs[t]);
+    }
+    for(long t = 0; t < threads; t++) pthread_join(tids[t], NULL);
+    const double wall = now_seconds() - t0;
+
+    size_t active = 0;
+    for(size_t b = 0; b < bins; b++) {
+        if(!morse_skimmer_channel_active(skimmer, b)) continue;
+        MorseSkimmerChannel* ch = morse_skimmer_channel(skimmer, b);
+        printf("%7.1f Hz %5.1f WPM  %s\n", ch->freq, morse_skimmer_channel_wpm(ch), ch->text);
+        active++;
+    }
+
+    const double audio = (double)wav.count / (double)wav.sample_rate;
+    const double rtf = (wall > 0.0) ? audio / wall : 0.0;
+    fprintf(
+        stderr,
+        "%.1f s audio, %zu bins, %ld threads, %.3f s wall: %.0fx real time\n",
+        audio,
+        bins,
+        threads,
+        wall,
+        rtf);
+    for(long t = 0; t < threads; t++) {
+        fprintf(
+            stderr,
+            "  thread %ld: bins %zu-%zu, %.3f s\n",
+            t,
+            jobs[t].bin_first,
+            jobs[t].bin_last,
+            jobs[t].seconds);
+    }
+    fprintf(
+        stderr,
+        "throughput: %zu channels x %.0fx = %.0f channel-RT (%.0f bin-RT)\n",
+        active,
+        rtf,
+        (double)active * rtf,
+        (double)bins * rtf);
+
+    free(jobs);
+    free(tids);
+    morse_skimmer_free(skimmer);
+    free(pcm);
+    wav_free(&wav);
+    return 0;
+}
@@ -0,0 +1,167 @@
+#define _GNU_SOURCE
+#include "pool.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct {
+    pthread_mutex_t mutex; /* owner and thieves both take it: tasks are coarse */
+    void** tasks;
+    size_t head; /* thieves take from here */
+    size_t tail; /* owner pushes / pops here */
+    size_t capacity;
+} PoolDeque;
+
+typedef struct {
+    Pool* pool;
+    unsigned index;
+    uint32_t rng;
+    pthread_t thread;
+    PoolWorkerStats stats;
+    PoolDeque deque;
+} PoolWorker;
+
+struct Pool {
+    unsigned count;
+    bool pin;
+    PoolWorker* workers;
+    PoolTaskCallback callback;
+    void* context;
+};
+
+static double pool_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void* pool_deque_pop(PoolDeque* deque) {
+    void* task = NULL;
+    pthread_mutex_lock(&deque->mutex);
+    if(deque->tail > deque->head) task = deque->tasks[--deque->tail];
+    pthread_mutex_unlock(&deque->mutex);
+    return task;
+}
+
+static void* pool_deque_steal(PoolDeque* deque) {
+    void* task = NULL;
+    pthread_mutex_lock(&deque->mutex);
+    if(deque->tail > deque->head) task = deque->tasks[deque->head++];
+    pthread_mutex_unlock(&deque->mutex);
+    return task;
+}
+
+static void* pool_steal(PoolWorker* self) {
+    Pool* pool = self->pool;
+    /* start at a random victim so thieves do not all pile onto worker 0 */
+    self->rng ^= self->rng << 13;
+    self->rng ^= self->rng >> 17;
+    self->rng ^= self->rng << 5;
+    const unsigned first = self->rng % pool->count;
+    for(unsigned n = 0; n < pool->count; n++) {
+        PoolWorker* victim = &pool->workers[(first + n) % pool->count];
+        if(victim == self) continue;
+        void* task = pool_deque_steal(&victim->deque);
+        if(task) return task;
+    }
+    return NULL;
+}
+
+static void pool_pin(PoolWorker* self) {
+#ifdef __linux__
+    const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if(self->pool->pin && cores > 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(self->index % (unsigned)cores, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+#else
+    (void)self;
+#endif
+}
+
+static void* pool_worker_thread(void* context) {
+    PoolWorker* self = context;
+    Pool* pool = self->pool;
+    pool_pin(self);
+
+    for(;;) {
+        bool stolen = false;
+        void* task = pool_deque_pop(&self->deque);
+        if(!task) {
+            task = pool_steal(self);
+            stolen = true;
+        }
+        if(!task) break;
+
+        const double t0 = pool_now();
+        pool->callback(task, self->index, pool->context);
+        self->stats.busy_s += pool_now() - t0;
+        self->stats.tasks++;
+        if(stolen) self->stats.stolen++;
+    }
+
+#ifdef __linux__
+    const int cpu = sched_getcpu();
+    if(cpu >= 0) self->stats.cpu = (unsigned)cpu;
+#endif
+    return NULL;
+}
+
+Pool* pool_alloc(unsigned workers, bool pin) {
+    Pool* pool = calloc(1, sizeof(Pool));
+    pool->count = workers ? workers : 1;
+    pool->pin = pin;
+    pool->workers = calloc(pool->count, sizeof(PoolWorker));
+    for(unsigned i = 0; i < pool->count; i++) {
+        PoolWorker* w = &pool->workers[i];
+        w->pool = pool;
+        w->index = i;
+        w->rng = 0x9E3779B9u * (i + 1);
+        w->stats.cpu = i;
+        pthread_mutex_init(&w->deque.mutex, NULL);
+    }
+    return pool;
+}
+
+void pool_free(Pool* pool) {
+    for(unsigned i = 0; i < pool->count; i++) {
+        pthread_mutex_destroy(&pool->workers[i].deque.mutex);
+        free(pool->workers[i].deque.tasks);
+    }
+    free(pool->workers);
+    free(pool);
+}
+
+unsigned pool_workers(const Pool* pool) {
+    return pool->count;
+}
+
+void pool_push(Pool* pool, unsigned worker, void* task) {
+    PoolDeque* deque = &pool->workers[worker % pool->count].deque;
+    if(deque->tail == deque->capacity) {
+        deque->capacity = deque->capacity ? deque->capacity * 2 : 16;
+        deque->tasks = realloc(deque->tasks, deque->capacity * sizeof(void*));
+    }
+    deque->tasks[deque->tail++] = task;
+}
+
+void pool_run(Pool* pool, PoolTaskCallback callback, void* context) {
+    pool->callback = callback;
+    pool->context = context;
+    for(unsigned i = 0; i < pool->count; i++) {
+        pthread_create(&pool->workers[i].thread, NULL, pool_worker_thread, &pool->workers[i]);
+    }
+    for(unsigned i = 0; i < pool->count; i++) {
+        pthread_join(pool->workers[i].thread, NULL);
+        pool->workers[i].deque.head = 0;
+        pool->workers[i].deque.tail = 0;
+    }
+}
+
+const PoolWorkerStats* pool_stats(const Pool* pool, unsigned worker) {
+    return &pool->workers[worker].stats;
+}
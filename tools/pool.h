@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Work-stealing thread pool for the host tools. Each worker owns a deque:
+ * it pops its own work from the back (newest first) and, once empty,
+ * steals from the front of a victim's deque (oldest first). Which tasks
+ * that leaves to thieves is up to the order the caller pushes them in.
+ * Tasks are queued up front and do not spawn more, so a worker that finds
+ * every deque empty is done. */
+
+typedef void (*PoolTaskCallback)(void* task, unsigned worker, void* context);
+
+typedef struct {
+    unsigned cpu;     /* core the worker was pinned to / last ran on */
+    uint64_t tasks;   /* tasks run, including stolen ones */
+    uint64_t stolen;
+    double busy_s;    /* time spent inside task callbacks */
+} PoolWorkerStats;
+
+typedef struct Pool Pool;
+
+/* `pin` binds worker i to online core i % cores where the OS allows it */
+Pool* pool_alloc(unsigned workers, bool pin);
+void pool_free(Pool* pool);
+
+unsigned pool_workers(const Pool* pool);
+/* queue before pool_run; not thread-safe against a running pool */
+void pool_push(Pool* pool, unsigned worker, void* task);
+/* runs every queued task, returns once all workers are idle */
+void pool_run(Pool* pool, PoolTaskCallback callback, void* context);
+const PoolWorkerStats* pool_stats(const Pool* pool, unsigned worker);
@@ -0,0 +1,235 @@
+#include "skimmer.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* detector tuning */
+#define SKIMMER_SNR_MIN 15.0f       /* peak / noise before a bin counts as keyed */
+#define SKIMMER_HYST_ON 1.4f        /* x geometric mean of noise and peak */
+#define SKIMMER_HYST_OFF 0.7f
+#define SKIMMER_NOISE_FALL 0.05f    /* per hop, toward lower power */
+#define SKIMMER_NOISE_DOUBLE_MS 1000.0f /* fastest climb toward higher power */
+#define SKIMMER_PEAK_HALF_MS 2000.0f
+#define SKIMMER_WARMUP_MS 250.0f    /* let the noise floor settle first */
+#define SKIMMER_FLOOR_DBFS -70.0f   /* noise never counts as lower: digital silence */
+
+/* decoder tuning */
+#define SKIMMER_DIT_INIT_MS 60.0f   /* 20 WPM */
+#define SKIMMER_DIT_MIN_MS 20.0f    /* 60 WPM */
+#define SKIMMER_DIT_MAX_MS 240.0f   /* 5 WPM */
+#define SKIMMER_GLITCH 0.3f         /* marks shorter than this x dit are noise */
+#define SKIMMER_MIN_CHARS 3         /* before a bin is reported */
+
+/* reporting: window sidelobes and key clicks of a strong carrier reach
+ * well past the adjacent bins */
+#define SKIMMER_SIDELOBE_BINS 4     /* must be the strongest within this many bins */
+#define SKIMMER_RANGE_DB 40.0f      /* and within this of the strongest signal */
+
+struct MorseSkimmer {
+    MorseSkimmerConfig config;
+    float hop_ms;
+    float peak_decay;
+    float noise_rise;
+    uint32_t warmup; /* hops */
+    float noise_min; /* SKIMMER_FLOOR_DBFS as bin power */
+    float* window; /* Hann */
+    size_t bins;
+    MorseSkimmerChannel* channels;
+};
+
+MorseSkimmer* morse_skimmer_alloc(const MorseSkimmerConfig* config) {
+    MorseSkimmer* skimmer = calloc(1, sizeof(MorseSkimmer));
+    skimmer->config = *config;
+    const float fs = (float)config->sample_rate;
+    const float spacing =
+        (config->bin_spacing > 0.0f) ? config->bin_spacing : fs / (float)config->window;
+
+    skimmer->hop_ms = 1000.0f * (float)config->hop / fs;
+    skimmer->peak_decay = powf(0.5f, skimmer->hop_ms / SKIMMER_PEAK_HALF_MS);
+    skimmer->noise_rise = powf(2.0f, skimmer->hop_ms / SKIMMER_NOISE_DOUBLE_MS);
+    skimmer->warmup = (uint32_t)(SKIMMER_WARMUP_MS / skimmer->hop_ms);
+    /* a sine of amplitude a lands in its bin as (a * window / 4)^2 (Hann) */
+    const float floor_amp = powf(10.0f, SKIMMER_FLOOR_DBFS / 20.0f) * (float)config->window / 4.0f;
+    skimmer->noise_min = floor_amp * floor_amp;
+
+    skimmer->window = malloc(config->window * sizeof(float));
+    for(uint32_t i = 0; i < config->window; i++) {
+        skimmer->window[i] =
+            0.5f - 0.5f * cosf(2.0f * (float)M_PI * (float)i / (float)(config->window - 1));
+    }
+
+    skimmer->bins = (size_t)((config->f_hi - config->f_lo) / spacing) + 1;
+    skimmer->channels = calloc(skimmer->bins, sizeof(MorseSkimmerChannel));
+    for(size_t b = 0; b < skimmer->bins; b++) {
+        MorseSkimmerChannel* ch = &skimmer->channels[b];
+        ch->freq = config->f_lo + spacing * (float)b;
+        ch->coeff = 2.0f * cosf(2.0f * (float)M_PI * ch->freq / fs);
+        ch->dit_ms = SKIMMER_DIT_INIT_MS;
+        ch->letter_sent = true;
+        ch->word_sent = true;
+        morse_code_decoder_reset(&ch->decoder);
+    }
+    return skimmer;
+}
+
+void morse_skimmer_free(MorseSkimmer* skimmer) {
+    free(skimmer->channels);
+    free(skimmer->window);
+    free(skimmer);
+}
+
+size_t morse_skimmer_bins(const MorseSkimmer* skimmer) {
+    return skimmer->bins;
+}
+
+MorseSkimmerChannel* morse_skimmer_channel(MorseSkimmer* skimmer, size_t bin) {
+    return (bin < skimmer->bins) ? &skimmer->channels[bin] : NULL;
+}
+
+static void morse_skimmer_emit(MorseSkimmerChannel* ch, char c) {
+    if(ch->text_len + 1 >= MORSE_SKIMMER_TEXT_MAX) return;
+    ch->text[ch->text_len++] = c;
+    ch->text[ch->text_len] = '\0';
+}
+
+/* a mark just ended: classify with the current estimate, then adapt it */
+static void morse_skimmer_mark(MorseSkimmerChannel* ch, float ms) {
+    if(ms < ch->dit_ms * SKIMMER_GLITCH) return;
+
+    /* core thresholds: <= dot_max is a dot, <= 3 dot_max a dash */
+    morse_code_decoder_mark(&ch->decoder, (uint32_t)ms, (uint32_t)(2.0f * ch->dit_ms));
+
+    /* a dash takes three units; anything much longer than a dash means the
+     * estimate is too short (dots were being taken for dashes), so let it
+     * pull the estimate up; a stuck carrier says nothing about speed */
+    const float unit = (ms < 2.0f * ch->dit_ms) ? ms : ms / 3.0f;
+    if(ms < 12.0f * ch->dit_ms) ch->dit_ms += (unit - ch->dit_ms) * 0.3f;
+    if(ch->dit_ms < SKIMMER_DIT_MIN_MS) ch->dit_ms = SKIMMER_DIT_MIN_MS;
+    if(ch->dit_ms > SKIMMER_DIT_MAX_MS) ch->dit_ms = SKIMMER_DIT_MAX_MS;
+    ch->letter_sent = false;
+    ch->word_sent = false;
+}
+
+/* silence keeps growing: letter gap at 2 dits, word gap at 5 */
+static void morse_skimmer_space(MorseSkimmerChannel* ch, float ms) {
+    if(!ch->letter_sent && ms >= 2.0f * ch->dit_ms) {
+        const char c = morse_code_decoder_letter(&ch->decoder);
+        if(c) {
+            morse_skimmer_emit(ch, c);
+            ch->chars++;
+        }
+        ch->letter_sent = true;
+    }
+    if(!ch->word_sent && ms >= 5.0f * ch->dit_ms) {
+        if(ch->text_len && ch->text[ch->text_len - 1] != ' ') morse_skimmer_emit(ch, ' ');
+        ch->word_sent = true;
+    }
+}
+
+static void morse_skimmer_detect(
+    MorseSkimmer* skimmer, MorseSkimmerChannel* ch, float power, uint32_t hop) {
+    ch->energy += power;
+    if(ch->noise <= 0.0f) {
+        ch->noise = power;
+        ch->peak = power;
+    }
+
+    /* noise floor: the mean of the bin while it sits below the threshold;
+     * otherwise (mark or its onset) it still follows dips but climbs at a
+     * bounded rate, so a carrier tens of dB up cannot drag it along */
+    const bool idle = !ch->on && power * power < ch->noise * ch->peak;
+    if(power < ch->noise || idle) {
+        ch->noise += (power - ch->noise) * SKIMMER_NOISE_FALL;
+    } else {
+        ch->noise *= skimmer->noise_rise;
+        if(ch->noise > power) ch->noise = power;
+    }
+    if(ch->noise < skimmer->noise_min) ch->noise = skimmer->noise_min;
+    ch->peak = (power > ch->peak) ? power : ch->peak * skimmer->peak_decay;
+    if(ch->peak < ch->noise) ch->peak = ch->noise;
+
+    bool on = false;
+    if(hop >= skimmer->warmup && ch->peak > ch->noise * SKIMMER_SNR_MIN) {
+        const float threshold = sqrtf(ch->noise * ch->peak);
+        on = power > threshold * (ch->on ? SKIMMER_HYST_OFF : SKIMMER_HYST_ON);
+    }
+
+    if(on != ch->on) {
+        if(ch->on) morse_skimmer_mark(ch, (float)ch->run * skimmer->hop_ms);
+        ch->on = on;
+        ch->run = 0;
+    }
+    ch->run++;
+    if(!ch->on) morse_skimmer_space(ch, (float)ch->run * skimmer->hop_ms);
+}
+
+void morse_skimmer_process(
+    MorseSkimmer* skimmer,
+    const float* pcm,
+    size_t count,
+    size_t bin_first,
+    size_t bin_last) {
+    const uint32_t window = skimmer->config.window;
+    const uint32_t hop = skimmer->config.hop;
+    if(bin_last > skimmer->bins) bin_last = skimmer->bins;
+    if(bin_first >= bin_last) return;
+
+    /* hop-major: window each block once, then run every bin of this range
+     * over the same (cache-hot) block */
+    float* block = malloc(window * sizeof(float));
+    uint32_t n = 0;
+    for(size_t start = 0; start + window <= count; start += hop, n++) {
+        for(uint32_t i = 0; i < window; i++) block[i] = pcm[start + i] * skimmer->window[i];
+
+        for(size_t b = bin_first; b < bin_last; b++) {
+            MorseSkimmerChannel* ch = &skimmer->channels[b];
+            const float coeff = ch->coeff;
+            float s1 = 0.0f, s2 = 0.0f;
+            for(uint32_t i = 0; i < window; i++) {
+                const float s0 = block[i] + coeff * s1 - s2;
+                s2 = s1;
+                s1 = s0;
+            }
+            const float power = s1 * s1 + s2 * s2 - coeff * s1 * s2;
+            morse_skimmer_detect(skimmer, ch, power, n);
+        }
+    }
+    free(block);
+
+    /* flush letters still pending at the end of the stream */
+    for(size_t b = bin_first; b < bin_last; b++) {
+        MorseSkimmerChannel* ch = &skimmer->channels[b];
+        if(ch->on) morse_skimmer_mark(ch, (float)ch->run * skimmer->hop_ms);
+        ch->on = false;
+        morse_skimmer_space(ch, 1e9f);
+    }
+}
+
+bool morse_skimmer_channel_active(MorseSkimmer* skimmer, size_t bin) {
+    if(bin >= skimmer->bins) return false;
+    const MorseSkimmerChannel* ch = &skimmer->channels[bin];
+    if(ch->chars < SKIMMER_MIN_CHARS) return false;
+
+    /* strongest within the sidelobe span; ties go to the lower bin */
+    const size_t lo = (bin > SKIMMER_SIDELOBE_BINS) ? bin - SKIMMER_SIDELOBE_BINS : 0;
+    const size_t hi = bin + SKIMMER_SIDELOBE_BINS;
+    for(size_t b = lo; b <= hi && b < skimmer->bins; b++) {
+        const double e = skimmer->channels[b].energy;
+        if(b < bin ? e >= ch->energy : e > ch->energy) return false;
+    }
+
+    /* far sidelobes of a strong signal still decode: drop anything that
+     * far below the strongest decoding bin */
+    double strongest = 0.0;
+    for(size_t b = 0; b < skimmer->bins; b++) {
+        const MorseSkimmerChannel* other = &skimmer->channels[b];
+        if(other->chars >= SKIMMER_MIN_CHARS && other->energy > strongest)
+            strongest = other->energy;
+    }
+    return ch->energy >= strongest * pow(10.0, -SKIMMER_RANGE_DB / 10.0);
+}
+
+float morse_skimmer_channel_wpm(const MorseSkimmerChannel* channel) {
+    /* PARIS: 50 dits per word */
+    return 1200.0f / channel->dit_ms;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "morse_code_core.h"
+
+/* Multi-signal CW skimmer: a Goertzel filter bank over one PCM stream, with
+ * an independent envelope detector and Morse decoder per frequency bin */
+
+#define MORSE_SKIMMER_TEXT_MAX 4096
+
+typedef struct {
+    uint32_t sample_rate;
+    uint32_t window;   /* Goertzel length (samples): sets the bin width */
+    uint32_t hop;      /* samples between detector updates: sets time resolution */
+    float f_lo;        /* band to scan, Hz */
+    float f_hi;
+    float bin_spacing; /* Hz between bins; 0 = sample_rate / window */
+} MorseSkimmerConfig;
+
+typedef struct {
+    float freq;
+    float coeff; /* Goertzel 2cos(w) */
+
+    /* envelope detector */
+    float noise;
+    float peak;
+    double energy; /* for picking the strongest of adjacent bins */
+    bool on;
+    uint32_t run; /* hops in the current mark / space */
+
+    /* decoder */
+    MorseCodeDecoder decoder;
+    float dit_ms; /* adaptive element length estimate */
+    bool letter_sent;
+    bool word_sent;
+    uint32_t chars;
+    size_t text_len;
+    char text[MORSE_SKIMMER_TEXT_MAX];
+} MorseSkimmerChannel;
+
+typedef struct MorseSkimmer MorseSkimmer;
+
+MorseSkimmer* morse_skimmer_alloc(const MorseSkimmerConfig* config);
+void morse_skimmer_free(MorseSkimmer* skimmer);
+
+size_t morse_skimmer_bins(const MorseSkimmer* skimmer);
+MorseSkimmerChannel* morse_skimmer_channel(MorseSkimmer* skimmer, size_t bin);
+
+/* Runs bins [bin_first, bin_last) over the whole stream. Bins share no state,
+ * so disjoint ranges may be processed concurrently from different threads */
+void morse_skimmer_process(
+    MorseSkimmer* skimmer,
+    const float* pcm,
+    size_t count,
+    size_t bin_first,
+    size_t bin_last);
+
+/* a bin carries a signal worth reporting: decoded text and the strongest
+ * of its neighbours (a keyed carrier leaks into adjacent bins) */
+bool morse_skimmer_channel_active(MorseSkimmer* skimmer, size_t bin);
+float morse_skimmer_channel_wpm(const MorseSkimmerChannel* channel);
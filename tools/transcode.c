@@ -0,0 +1,148 @@
+#include "transcode.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TRANSCODE_TONE_CHUNK 4096
+
+/* per byte: its elements, zero-padded to one store width */
+static uint8_t transcode_table[256][TRANSCODE_STORE];
+static uint8_t transcode_len[256];
+
+void transcode_init(void) {
+    for(unsigned c = 0; c < 256; c++) {
+        const char s = (char)c;
+        transcode_len[c] =
+            (uint8_t)morse_code_compile(&s, 1, transcode_table[c], MORSE_CODE_CHAR_ELEMENTS_MAX);
+    }
+}
+
+size_t transcode_encode(const uint8_t* in, size_t len, uint8_t* out) {
+    /* branch-free: always store a whole table row (a single 16-byte vector
+     * move), then advance by the real length; the next store overwrites
+     * the padding */
+    uint8_t* p = out;
+    for(size_t i = 0; i < len; i++) {
+        memcpy(p, transcode_table[in[i]], TRANSCODE_STORE);
+        p += transcode_len[in[i]];
+    }
+    return (size_t)(p - out);
+}
+
+/* ---------- edges ---------- */
+
+static size_t transcode_edge_record(char* out, bool tone, uint32_t ms) {
+    char digits[10];
+    size_t n = 0;
+    do {
+        digits[n++] = (char)('0' + ms % 10);
+        ms /= 10;
+    } while(ms);
+
+    size_t len = 0;
+    out[len++] = 'E';
+    out[len++] = ':';
+    out[len++] = ' ';
+    out[len++] = tone ? '1' : '0';
+    out[len++] = ' ';
+    while(n) out[len++] = digits[--n];
+    out[len++] = '\n';
+    return len;
+}
+
+size_t transcode_edges(
+    TranscodeEdges* edges,
+    const TranscodeTiming* timing,
+    const uint8_t* elements,
+    size_t count,
+    char* out) {
+    size_t len = 0;
+    for(size_t i = 0; i < count; i++) {
+        const bool tone = morse_code_element_is_tone(elements[i]);
+        const uint32_t ms = morse_code_element_ms(elements[i], timing->dit, timing->gap_delta);
+        /* tones are always separated by a gap, so only silences merge */
+        if(edges->open && !(edges->tone || tone)) {
+            edges->ms += ms;
+            continue;
+        }
+        if(edges->open) len += transcode_edge_record(out + len, edges->tone, edges->ms);
+        edges->open = true;
+        edges->tone = tone;
+        edges->ms = ms;
+    }
+    return len;
+}
+
+size_t transcode_edges_flush(TranscodeEdges* edges, char* out) {
+    if(!edges->open) return 0;
+    edges->open = false;
+    return transcode_edge_record(out, edges->tone, edges->ms);
+}
+
+/* ---------- audio ---------- */
+
+bool transcode_tone(
+    TranscodeTone* tone, const TranscodeTiming* timing, const uint8_t* elements, size_t count) {
+    int16_t buf[TRANSCODE_TONE_CHUNK];
+    size_t fill = 0;
+    const uint32_t rate = tone->writer->sample_rate;
+    const double step = 2.0 * M_PI * tone->freq / rate;
+
+    for(size_t i = 0; i < count; i++) {
+        const bool on = morse_code_element_is_tone(elements[i]);
+        tone->ms += morse_code_element_ms(elements[i], timing->dit, timing->gap_delta);
+        /* derive every boundary from the ms timeline so rounding never drifts */
+        const uint64_t end = tone->ms * rate / 1000u;
+        const uint64_t n = end - tone->samples;
+        tone->samples = end;
+
+        for(uint64_t k = 0; k < n; k++) {
+            float v = 0.0f;
+            if(on) {
+                float gain = tone->amplitude;
+                const uint64_t edge = (k < n - 1 - k) ? k : n - 1 - k;
+                if(edge < tone->ramp)
+                    gain *= 0.5f - 0.5f * cosf((float)M_PI * (float)edge / (float)tone->ramp);
+                v = gain * (float)sin(tone->phase);
+                tone->phase += step;
+                if(tone->phase > 2.0 * M_PI) tone->phase -= 2.0 * M_PI;
+            }
+            buf[fill++] = (int16_t)lrintf(v * 32767.0f);
+            if(fill == TRANSCODE_TONE_CHUNK) {
+                if(!wav_writer_write(tone->writer, buf, fill)) return false;
+                fill = 0;
+            }
+        }
+    }
+    return fill == 0 || wav_writer_write(tone->writer, buf, fill);
+}
+
+/* ---------- decode ---------- */
+
+void transcode_decoder_init(
+    TranscodeDecoder* decoder, const TranscodeTiming* timing, TranscodeGaps gaps) {
+    morse_code_decoder_reset(&decoder->decoder);
+    decoder->dit = timing->dit;
+    /* same unit morse_code_element_ms stretches letter / word gaps with */
+    const uint32_t unit = (timing->gap_delta > timing->dit) ? timing->gap_delta : timing->dit;
+    decoder->letter_gap = unit * gaps.letter;
+    decoder->word_gap = unit * gaps.word;
+}
+
+size_t transcode_decode_line(TranscodeDecoder* decoder, const char* line, char* out) {
+    if(line[0] != 'E' || line[1] != ':' || line[2] != ' ') return 0;
+    const bool down = line[3] == '1';
+    const uint32_t ms = (uint32_t)strtoul(line + 5, NULL, 10);
+    /* same calls the keying thread makes on release / next press */
+    if(down) {
+        morse_code_decoder_mark(&decoder->decoder, ms, decoder->dit);
+        return 0;
+    }
+    return morse_code_decoder_gap(
+        &decoder->decoder, ms, decoder->letter_gap, decoder->word_gap, out);
+}
+
+size_t transcode_decode_end(TranscodeDecoder* decoder, char* out) {
+    return morse_code_decoder_gap(
+        &decoder->decoder, UINT32_MAX, decoder->letter_gap, decoder->word_gap, out);
+}
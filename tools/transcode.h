@@ -0,0 +1,92 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "morse_code_core.h"
+#include "wav.h"
+
+/* Batch encode / decode stages for the host tools. Every stage reproduces
+ * what the app does on the device: elements match morse_code_worker_compile,
+ * durations match the playback thread, and trace decoding follows the
+ * keying thread's rules */
+
+/* bytes per table store in the fast encoder; one covers any character */
+#define TRANSCODE_STORE 16
+/* output room transcode_encode needs for `len` input bytes */
+#define TRANSCODE_ENCODE_BOUND(len) ((len) * MORSE_CODE_CHAR_ELEMENTS_MAX + TRANSCODE_STORE)
+/* longest "E: <0|1> <ms>\n" record */
+#define TRANSCODE_EDGE_MAX 16
+
+typedef struct {
+    uint32_t dit;       /* ms, the app's Dit setting */
+    uint32_t gap_delta; /* Farnsworth gap unit, 0 = none */
+} TranscodeTiming;
+
+/* ---------- encode ---------- */
+
+/* builds the per-byte element table from morse_code_compile */
+void transcode_init(void);
+/* text -> elements, one fixed-width table store per input byte */
+size_t transcode_encode(const uint8_t* in, size_t len, uint8_t* out);
+
+/* elements -> edge records in session-log form ("E: <1|0> <ms>"), with
+ * adjacent silences merged into one key-up record */
+typedef struct {
+    bool open; /* a record is being accumulated */
+    bool tone;
+    uint32_t ms;
+} TranscodeEdges;
+
+/* `out` needs TRANSCODE_EDGE_MAX bytes per element */
+size_t transcode_edges(
+    TranscodeEdges* edges,
+    const TranscodeTiming* timing,
+    const uint8_t* elements,
+    size_t count,
+    char* out);
+size_t transcode_edges_flush(TranscodeEdges* edges, char* out);
+
+/* elements -> audio, written as it is rendered */
+typedef struct {
+    WavWriter* writer;
+    float freq;
+    float amplitude;
+    uint32_t ramp;    /* samples of raised-cosine attack / release */
+    uint64_t ms;      /* timeline position */
+    uint64_t samples; /* samples written: stays locked to `ms` */
+    double phase;
+} TranscodeTone;
+
+bool transcode_tone(
+    TranscodeTone* tone, const TranscodeTiming* timing, const uint8_t* elements, size_t count);
+
+/* ---------- decode ---------- */
+
+/* gap thresholds in gap units: a letter ends past `letter`, a word past `word` */
+typedef struct {
+    uint32_t letter;
+    uint32_t word;
+} TranscodeGaps;
+
+/* the keying thread's rules, for session logs */
+#define TRANSCODE_GAPS_KEYER \
+    ((TranscodeGaps){.letter = MORSE_CODE_LETTER_GAP_UNITS, .word = MORSE_CODE_WORD_GAP_UNITS})
+/* midway between the nominal 1 / 3 / 7 units, for traces written by the encoder */
+#define TRANSCODE_GAPS_NOMINAL ((TranscodeGaps){.letter = 2, .word = 5})
+
+/* edge records -> text, as the keying thread would have decoded them */
+typedef struct {
+    MorseCodeDecoder decoder;
+    uint32_t dit;
+    uint32_t letter_gap; /* ms */
+    uint32_t word_gap;   /* ms */
+} TranscodeDecoder;
+
+/* gaps are measured in the Dit, or in the Farnsworth unit if longer */
+void transcode_decoder_init(
+    TranscodeDecoder* decoder, const TranscodeTiming* timing, TranscodeGaps gaps);
+/* one log line; lines other than "E:" records are ignored. `out` needs 2 bytes */
+size_t transcode_decode_line(TranscodeDecoder* decoder, const char* line, char* out);
+/* end of trace: the key stays up for good */
+size_t transcode_decode_end(TranscodeDecoder* decoder, char* out);
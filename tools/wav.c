@@ -0,0 +1,139 @@
+#include "wav.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint32_t wav_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void wav_put_u32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static void wav_put_u16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static uint16_t wav_u16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+bool wav_read(const char* path, Wav* wav) {
+    memset(wav, 0, sizeof(Wav));
+    FILE* f = fopen(path, "rb");
+    if(!f) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+
+    bool ok = false;
+    uint8_t hdr[12];
+    uint16_t channels = 0, bits = 0, format = 0;
+    do {
+        if(fread(hdr, 1, 12, f) != 12 || memcmp(hdr, "RIFF", 4) || memcmp(hdr + 8, "WAVE", 4)) {
+            fprintf(stderr, "%s: not a RIFF/WAVE file\n", path);
+            break;
+        }
+        uint8_t chunk[8];
+        while(fread(chunk, 1, 8, f) == 8) {
+            const uint32_t size = wav_u32(chunk + 4);
+            if(!memcmp(chunk, "fmt ", 4)) {
+                uint8_t fmt[16];
+                if(size < 16 || fread(fmt, 1, 16, f) != 16) break;
+                format = wav_u16(fmt);
+                channels = wav_u16(fmt + 2);
+                wav->sample_rate = wav_u32(fmt + 4);
+                bits = wav_u16(fmt + 14);
+                fseek(f, (long)(size - 16 + (size & 1)), SEEK_CUR);
+            } else if(!memcmp(chunk, "data", 4)) {
+                if(format != 1 || bits != 16 || channels == 0) {
+                    fprintf(stderr, "%s: only 16-bit PCM is supported\n", path);
+                    break;
+                }
+                const size_t frames = size / (2u * channels);
+                int16_t* raw = malloc(frames * channels * sizeof(int16_t));
+                if(!raw) break;
+                const size_t got = fread(raw, 2u * channels, frames, f);
+                wav->samples = malloc((got ? got : 1) * sizeof(int16_t));
+                for(size_t i = 0; i < got; i++) {
+                    const uint8_t* p = (const uint8_t*)&raw[i * channels];
+                    wav->samples[i] = (int16_t)wav_u16(p);
+                }
+                free(raw);
+                wav->count = got;
+                ok = true;
+                break;
+            } else {
+                fseek(f, (long)(size + (size & 1)), SEEK_CUR);
+            }
+        }
+        if(!ok && !wav->samples) fprintf(stderr, "%s: no PCM data\n", path);
+    } while(false);
+
+    fclose(f);
+    return ok;
+}
+
+void wav_free(Wav* wav) {
+    free(wav->samples);
+    wav->samples = NULL;
+    wav->count = 0;
+}
+
+static void wav_header(uint8_t* hdr, uint32_t sample_rate, size_t count) {
+    const uint32_t data = (uint32_t)(count * 2u);
+    memcpy(hdr, "RIFF", 4);
+    wav_put_u32(hdr + 4, 36 + data);
+    memcpy(hdr + 8, "WAVEfmt ", 8);
+    wav_put_u32(hdr + 16, 16);
+    wav_put_u16(hdr + 20, 1); /* PCM */
+    wav_put_u16(hdr + 22, 1); /* mono */
+    wav_put_u32(hdr + 24, sample_rate);
+    wav_put_u32(hdr + 28, sample_rate * 2u);
+    wav_put_u16(hdr + 32, 2);
+    wav_put_u16(hdr + 34, 16);
+    memcpy(hdr + 36, "data", 4);
+    wav_put_u32(hdr + 40, data);
+}
+
+bool wav_writer_open(WavWriter* writer, const char* path, uint32_t sample_rate) {
+    writer->sample_rate = sample_rate;
+    writer->count = 0;
+    writer->file = fopen(path, "wb");
+    if(!writer->file) {
+        fprintf(stderr, "%s: cannot create\n", path);
+        return false;
+    }
+    uint8_t hdr[44];
+    wav_header(hdr, sample_rate, 0);
+    return fwrite(hdr, 1, sizeof(hdr), writer->file) == sizeof(hdr);
+}
+
+bool wav_writer_write(WavWriter* writer, const int16_t* samples, size_t count) {
+    uint8_t buf[4096];
+    size_t done = 0;
+    while(done < count) {
+        size_t n = count - done;
+        if(n > sizeof(buf) / 2) n = sizeof(buf) / 2;
+        for(size_t i = 0; i < n; i++) wav_put_u16(buf + 2 * i, (uint16_t)samples[done + i]);
+        if(fwrite(buf, 2, n, writer->file) != n) return false;
+        done += n;
+    }
+    writer->count += count;
+    return true;
+}
+
+bool wav_writer_close(WavWriter* writer) {
+    uint8_t hdr[44];
+    wav_header(hdr, writer->sample_rate, writer->count);
+    bool ok = fseek(writer->file, 0, SEEK_SET) == 0 &&
+              fwrite(hdr, 1, sizeof(hdr), writer->file) == sizeof(hdr);
+    if(fclose(writer->file) != 0) ok = false;
+    writer->file = NULL;
+    return ok;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* Minimal RIFF/WAVE PCM16 reader / streaming writer for the host tools */
+
+typedef struct {
+    uint32_t sample_rate;
+    size_t count;   /* samples (first channel only) */
+    int16_t* samples;
+} Wav;
+
+/* reads 16-bit PCM; multi-channel files keep channel 0. Returns false with
+ * a message on stderr for anything else */
+bool wav_read(const char* path, Wav* wav);
+void wav_free(Wav* wav);
+
+/* mono PCM16 written as it is produced; sizes are patched in on close */
+typedef struct {
+    FILE* file;
+    uint32_t sample_rate;
+    size_t count;
+} WavWriter;
+
+bool wav_writer_open(WavWriter* writer, const char* path, uint32_t sample_rate);
+bool wav_writer_write(WavWriter* writer, const int16_t* samples, size_t count);
+bool wav_writer_close(WavWriter* writer);